@@ -0,0 +1,138 @@
+#include "Benchmark.h"
+#include "../externals/json/single_include/nlohmann/json.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using json = nlohmann::json;
+
+void BenchmarkSuite::report(BenchmarkResult result)
+{
+    const double nsPerOp = result.Iterations ? result.Seconds * 1e9 / static_cast<double>(result.Iterations) : 0.0;
+    std::cerr << result.Name << ": " << result.Iterations << " ops in " << result.Seconds << " s, " << nsPerOp << " ns/op" << std::endl;
+    m_results.push_back(std::move(result));
+}
+
+static void printUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--filter <substring>] [--scale <factor>] [--seed <n>] [--out <file.json>] [--workdir <dir>]" << std::endl;
+}
+
+static json toJson(const BenchmarkSuite& suite)
+{
+    json benchmarks = json::array();
+    for (const auto& result : suite.results())
+    {
+        const double iterations = static_cast<double>(result.Iterations);
+        benchmarks.push_back({
+            { "name", result.Name },
+            { "iterations", result.Iterations },
+            { "seconds", result.Seconds },
+            { "ns_per_op", result.Iterations ? result.Seconds * 1e9 / iterations : 0.0 },
+            { "ops_per_sec", result.Seconds > 0.0 ? iterations / result.Seconds : 0.0 },
+            { "metrics", result.Metrics }
+        });
+    }
+
+    return {
+        { "schema_version", 1 },
+        { "seed", suite.options().Seed },
+        { "scale", suite.options().Scale },
+        { "benchmarks", benchmarks }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        if (arg == "--filter")
+        {
+            options.Filter = argv[++i];
+        }
+        else if (arg == "--scale")
+        {
+            options.Scale = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--seed")
+        {
+            options.Seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--out")
+        {
+            options.OutputFile = argv[++i];
+        }
+        else if (arg == "--workdir")
+        {
+            options.WorkDir = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.Scale <= 0.0)
+    {
+        std::cerr << "The scale must be positive." << std::endl;
+        return 1;
+    }
+
+    const bool ownWorkDir = options.WorkDir.empty();
+    if (ownWorkDir)
+    {
+        options.WorkDir = (std::filesystem::temp_directory_path() / ("rpcresolver_bench_" + std::to_string(options.Seed))).string();
+    }
+    std::filesystem::create_directories(options.WorkDir);
+
+    BenchmarkSuite suite(options);
+    try
+    {
+        runConfigBenchmarks(suite);
+        runEventBenchmarks(suite);
+        runDecodeBenchmarks(suite);
+        runSketchBenchmarks(suite);
+        runCrawlBenchmarks(suite);
+        runQueryBenchmarks(suite);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (ownWorkDir)
+    {
+        std::error_code error;
+        std::filesystem::remove_all(options.WorkDir, error);
+    }
+
+    const std::string report = toJson(suite).dump(2);
+    if (options.OutputFile.empty())
+    {
+        std::cout << report << std::endl;
+    }
+    else
+    {
+        std::ofstream output(options.OutputFile);
+        if (!output.is_open())
+        {
+            std::cerr << "Could not open file: " << options.OutputFile << std::endl;
+            return 1;
+        }
+        output << report << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/// @brief BenchmarkOptions struct to store the command line options of the benchmark runner \struct BenchmarkOptions
+struct BenchmarkOptions
+{
+    uint64_t Seed = 42;
+    double Scale = 1.0;
+    std::string Filter;
+    std::string OutputFile;
+    std::string WorkDir;
+};
+
+/// @brief BenchmarkResult struct to store one measured benchmark \struct BenchmarkResult
+struct BenchmarkResult
+{
+    BenchmarkResult(std::string name, uint64_t iterations, double seconds)
+        : Name(std::move(name)), Iterations(iterations), Seconds(seconds) {}
+
+    std::string Name;
+    uint64_t Iterations = 0;
+    double Seconds = 0.0;
+    std::map<std::string, double> Metrics;
+};
+
+/// @brief Stopwatch class to measure wall clock time \class Stopwatch
+class Stopwatch
+{
+public:
+    Stopwatch() : startTime(std::chrono::steady_clock::now()) {}
+
+    /*!
+     * @brief Get the time since construction
+     * @return double The elapsed seconds
+     */
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    /*!
+     * @brief Get the time since construction
+     * @return uint64_t The elapsed nanoseconds
+     */
+    uint64_t nanoseconds() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+};
+
+/// @brief ThreadCpuStopwatch class to measure the CPU time of the calling thread, time spent sleeping or blocked is not counted \class ThreadCpuStopwatch
+class ThreadCpuStopwatch
+{
+public:
+    ThreadCpuStopwatch() : startTime(now()) {}
+
+    /*!
+     * @brief Get the CPU time the constructing thread used since construction, call it from that thread
+     * @return uint64_t The CPU nanoseconds
+     */
+    uint64_t nanoseconds() const
+    {
+        return now() - startTime;
+    }
+
+private:
+    uint64_t startTime;
+
+    static uint64_t now()
+    {
+#ifdef _WIN32
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime);
+        const uint64_t kernel = static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32 | kernelTime.dwLowDateTime;
+        const uint64_t user = static_cast<uint64_t>(userTime.dwHighDateTime) << 32 | userTime.dwLowDateTime;
+        return (kernel + user) * 100;
+#else
+        timespec time;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + static_cast<uint64_t>(time.tv_nsec);
+#endif
+    }
+};
+
+/// @brief LatencyRecorder class to collect per operation latencies and report percentiles \class LatencyRecorder
+class LatencyRecorder
+{
+public:
+    /*!
+     * @brief Record one latency sample
+     * @param nanoseconds The latency
+     */
+    void record(uint64_t nanoseconds)
+    {
+        samples.push_back(nanoseconds);
+    }
+
+    /*!
+     * @brief Add p50, p99 and p999 metrics to a result
+     * @param result The result
+     */
+    void report(BenchmarkResult& result)
+    {
+        if (samples.empty())
+        {
+            return;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        result.Metrics["latency_p50_ns"] = static_cast<double>(percentile(0.50));
+        result.Metrics["latency_p99_ns"] = static_cast<double>(percentile(0.99));
+        result.Metrics["latency_p999_ns"] = static_cast<double>(percentile(0.999));
+        result.Metrics["latency_max_ns"] = static_cast<double>(samples.back());
+    }
+
+private:
+    std::vector<uint64_t> samples;
+
+    uint64_t percentile(double fraction) const
+    {
+        const size_t index = (std::min)(samples.size() - 1, static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+        return samples[index];
+    }
+};
+
+/// @brief BenchmarkSuite class to select, run and collect benchmarks \class BenchmarkSuite
+class BenchmarkSuite
+{
+public:
+    BenchmarkSuite(const BenchmarkOptions& options) : m_options(options) {}
+
+    /*!
+     * @brief Check if a benchmark passes the name filter
+     * @param name The benchmark name
+     * @return bool True if the benchmark should run, false otherwise
+     */
+    bool enabled(const std::string& name) const
+    {
+        return m_options.Filter.empty() || name.find(m_options.Filter) != std::string::npos;
+    }
+
+    /*!
+     * @brief Scale a workload size by the --scale option
+     * @param count The default size
+     * @return size_t The scaled size, at least 1
+     */
+    size_t scaled(size_t count) const
+    {
+        return (std::max)(size_t(1), static_cast<size_t>(static_cast<double>(count) * m_options.Scale));
+    }
+
+    /*!
+     * @brief Store a result
+     * @param result The result
+     */
+    void report(BenchmarkResult result);
+
+    /*!
+     * @brief Get the options
+     * @return const BenchmarkOptions& The options
+     */
+    const BenchmarkOptions& options() const
+    {
+        return m_options;
+    }
+
+    /*!
+     * @brief Get the results collected so far
+     * @return const std::vector<BenchmarkResult>& The results
+     */
+    const std::vector<BenchmarkResult>& results() const
+    {
+        return m_results;
+    }
+
+private:
+    BenchmarkOptions m_options;
+    std::vector<BenchmarkResult> m_results;
+};
+
+inline const void* volatile benchmarkSink = nullptr;
+
+/*!
+ * @brief Keep the compiler from optimizing away a computed value
+ * @param value The value
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    benchmarkSink = &value;
+}
+
+void runConfigBenchmarks(BenchmarkSuite& suite);
+void runEventBenchmarks(BenchmarkSuite& suite);
+void runDecodeBenchmarks(BenchmarkSuite& suite);
+void runSketchBenchmarks(BenchmarkSuite& suite);
+void runCrawlBenchmarks(BenchmarkSuite& suite);
+void runQueryBenchmarks(BenchmarkSuite& suite);
+
+#endif // BENCHMARK_H
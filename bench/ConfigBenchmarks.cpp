@@ -0,0 +1,244 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/RpcServersConfig.h"
+#include "../include/RpcServersDatabase.h"
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+static void benchmarkUuid(BenchmarkSuite& suite, const WorkloadGenerator& generator)
+{
+    std::vector<std::string> strings;
+    for (const auto& uuid : generator.interfaces())
+    {
+        strings.push_back(uuid.toString());
+    }
+
+    const size_t iterations = suite.scaled(2000000);
+    if (suite.enabled("uuid.parse"))
+    {
+        uint64_t checksum = 0;
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            RpcUuid uuid;
+            RpcUuid::parse(strings[i % strings.size()], uuid);
+            checksum += uuid.Low;
+        }
+
+        BenchmarkResult result{ "uuid.parse", iterations, stopwatch.seconds() };
+        result.Metrics["checksum"] = static_cast<double>(checksum & 0xffff);
+        suite.report(result);
+    }
+
+    if (suite.enabled("uuid.to_string"))
+    {
+        size_t checksum = 0;
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < iterations; i++)
+        {
+            checksum += generator.interfaces()[i % strings.size()].toString().size();
+        }
+
+        BenchmarkResult result{ "uuid.to_string", iterations, stopwatch.seconds() };
+        result.Metrics["checksum"] = static_cast<double>(checksum);
+        suite.report(result);
+    }
+}
+
+static void benchmarkLoad(BenchmarkSuite& suite, const WorkloadGenerator& generator)
+{
+    const std::string workDir = suite.options().WorkDir;
+    const size_t interfaceCount = generator.interfaces().size();
+
+    if (suite.enabled("config.load"))
+    {
+        const std::string filePath = workDir + "/rpc_servers.json";
+        generator.writeRpcServersFile(filePath, 0, interfaceCount, 0);
+
+        Stopwatch stopwatch;
+        RpcServersConfig config = RpcServersConfig::load(filePath);
+        BenchmarkResult result{ "config.load", 1, stopwatch.seconds() };
+        result.Metrics["interfaces"] = static_cast<double>(config.size());
+        result.Metrics["file_bytes"] = static_cast<double>(std::filesystem::file_size(filePath));
+        suite.report(result);
+    }
+
+    // one dump per OS build, each covering an overlapping window of interfaces
+    if (suite.enabled("config.merge"))
+    {
+        const size_t fileCount = 50;
+        const size_t window = interfaceCount * 6 / 10;
+        std::vector<std::string> filePaths;
+        for (size_t i = 0; i < fileCount; i++)
+        {
+            filePaths.push_back(workDir + "/rpc_servers_" + std::to_string(i) + ".json");
+            generator.writeRpcServersFile(filePaths.back(), i * interfaceCount / fileCount, window, i % 5);
+        }
+
+        size_t separateInterfaces = 0;
+        size_t separateStrings = 0;
+        size_t separateBytes = 0;
+        Stopwatch separateStopwatch;
+        for (const auto& filePath : filePaths)
+        {
+            RpcServersConfig config = RpcServersConfig::load(filePath);
+            separateInterfaces += config.size();
+            separateStrings += config.strings().size();
+            separateBytes += config.strings().bytes();
+        }
+        BenchmarkResult separate{ "config.merge.load_each_50", fileCount, separateStopwatch.seconds() };
+        separate.Metrics["interfaces"] = static_cast<double>(separateInterfaces);
+        separate.Metrics["pool_strings"] = static_cast<double>(separateStrings);
+        separate.Metrics["pool_bytes"] = static_cast<double>(separateBytes);
+        suite.report(separate);
+
+        std::vector<RpcMergeConflict> conflicts;
+        Stopwatch mergeStopwatch;
+        RpcServersConfig merged = RpcServersConfig::loadMany(filePaths, &conflicts);
+        BenchmarkResult result{ "config.merge.load_many_50", fileCount, mergeStopwatch.seconds() };
+        result.Metrics["interfaces"] = static_cast<double>(merged.size());
+        result.Metrics["pool_strings"] = static_cast<double>(merged.strings().size());
+        result.Metrics["pool_bytes"] = static_cast<double>(merged.strings().bytes());
+        result.Metrics["conflicts"] = static_cast<double>(conflicts.size());
+        result.Metrics["speedup"] = result.Seconds > 0.0 ? separate.Seconds / result.Seconds : 0.0;
+        suite.report(result);
+
+        for (const auto& filePath : filePaths)
+        {
+            std::filesystem::remove(filePath);
+        }
+    }
+}
+
+static void benchmarkLookup(BenchmarkSuite& suite, const WorkloadGenerator& generator, const RpcServersConfig& config)
+{
+    const std::vector<SyntheticCall> calls = generator.calls(suite.scaled(1000000), 1);
+
+    if (suite.enabled("lookup.get_rpc_info"))
+    {
+        // the string map API, kept for comparison with the record handles
+        std::vector<std::string> uuidStrings;
+        for (const auto& call : calls)
+        {
+            uuidStrings.push_back(call.InterfaceUuid.toString());
+        }
+
+        size_t checksum = 0;
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < calls.size(); i++)
+        {
+            checksum += config.getRpcInfo(uuidStrings[i], static_cast<int>(calls[i].ProcNum)).size();
+        }
+        BenchmarkResult result{ "lookup.get_rpc_info", calls.size(), stopwatch.seconds() };
+        result.Metrics["checksum"] = static_cast<double>(checksum);
+        suite.report(result);
+    }
+
+    if (suite.enabled("lookup.resolve"))
+    {
+        size_t resolved = 0;
+        Stopwatch stopwatch;
+        for (const auto& call : calls)
+        {
+            resolved += config.resolve(call.InterfaceUuid, static_cast<int>(call.ProcNum)).ProcedureName != nullptr;
+        }
+        BenchmarkResult result{ "lookup.resolve", calls.size(), stopwatch.seconds() };
+        result.Metrics["resolved"] = static_cast<double>(resolved);
+        suite.report(result);
+    }
+}
+
+static void benchmarkReload(BenchmarkSuite& suite, const WorkloadGenerator& generator, const RpcServersConfig& config)
+{
+    if (!suite.enabled("reload.under_replay"))
+    {
+        return;
+    }
+
+    // alternate between two freshly loaded builds so every publish hands the resolver a different table
+    std::vector<RpcServersConfig> builds;
+    for (uint64_t variant = 1; variant <= 2; variant++)
+    {
+        const std::string filePath = suite.options().WorkDir + "/rpc_servers_reload_" + std::to_string(variant) + ".json";
+        generator.writeRpcServersFile(filePath, 0, generator.interfaces().size(), variant);
+        builds.push_back(RpcServersConfig::load(filePath));
+        std::filesystem::remove(filePath);
+    }
+
+    const std::vector<SyntheticCall> calls = generator.calls(suite.scaled(1000000), 2);
+    RpcServersDatabase database(config);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> replayed(0);
+    uint64_t generationsSeen = 0;
+    uint64_t resolvedCount = 0;
+    LatencyRecorder latencies;
+
+    // one resolver replays the stream in a loop while the main thread keeps publishing new databases
+    std::thread resolver([&]() {
+        RpcServersDatabase::Reader reader(database);
+        uint64_t generation = 0;
+        uint64_t count = 0;
+        uint64_t resolved = 0;
+        while (!stop)
+        {
+            for (size_t i = 0; i < calls.size() && !stop; i++)
+            {
+                const SyntheticCall& call = calls[i];
+                if ((i & 1023) == 0)
+                {
+                    Stopwatch stopwatch;
+                    resolved += reader.current().resolve(call.InterfaceUuid, static_cast<int>(call.ProcNum)).Server != nullptr;
+                    latencies.record(stopwatch.nanoseconds());
+                }
+                else
+                {
+                    resolved += reader.current().resolve(call.InterfaceUuid, static_cast<int>(call.ProcNum)).Server != nullptr;
+                }
+                if (reader.current().generation() != generation)
+                {
+                    generation = reader.current().generation();
+                    generationsSeen++;
+                }
+                count++;
+            }
+        }
+        replayed = count;
+        resolvedCount = resolved;
+    });
+
+    const size_t reloads = suite.scaled(50);
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < reloads; i++)
+    {
+        database.publish(builds[i % builds.size()]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stop = true;
+    resolver.join();
+
+    BenchmarkResult result{ "reload.under_replay", replayed.load(), stopwatch.seconds() };
+    result.Metrics["reloads"] = static_cast<double>(reloads);
+    result.Metrics["generations_seen"] = static_cast<double>(generationsSeen);
+    result.Metrics["resolved"] = static_cast<double>(resolvedCount);
+    latencies.report(result);
+    suite.report(result);
+}
+
+void runConfigBenchmarks(BenchmarkSuite& suite)
+{
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    benchmarkUuid(suite, generator);
+    benchmarkLoad(suite, generator);
+
+    const std::string filePath = suite.options().WorkDir + "/rpc_servers_lookup.json";
+    generator.writeRpcServersFile(filePath, 0, generator.interfaces().size(), 0);
+    RpcServersConfig config = RpcServersConfig::load(filePath);
+    std::filesystem::remove(filePath);
+
+    benchmarkLookup(suite, generator, config);
+    benchmarkReload(suite, generator, config);
+}
@@ -0,0 +1,33 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/FileCrawler.h"
+#include <filesystem>
+
+void runCrawlBenchmarks(BenchmarkSuite& suite)
+{
+    if (!suite.enabled("crawl.directory_tree"))
+    {
+        return;
+    }
+
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    const std::string root = suite.options().WorkDir + "/tree";
+    std::filesystem::remove_all(root);
+    const size_t expected = generator.createDirectoryTree(root, suite.scaled(500), 40, 4);
+
+    FileCrawler crawler(root);
+    Stopwatch stopwatch;
+    const std::vector<std::string> found = crawler.findFiles({ ".json", ".xml" });
+    const double seconds = stopwatch.seconds();
+
+    BenchmarkResult result{ "crawl.directory_tree", suite.scaled(500) * 40, seconds };
+    result.Metrics["directories"] = static_cast<double>(suite.scaled(500));
+    result.Metrics["files_found"] = static_cast<double>(found.size());
+    result.Metrics["files_expected"] = static_cast<double>(expected);
+    suite.report(result);
+
+    std::filesystem::remove_all(root);
+}
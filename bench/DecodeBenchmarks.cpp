@@ -0,0 +1,435 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventSchema.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+/// @brief GenericFieldType enum of the wire formats the generic decoder interprets \enum GenericFieldType
+enum class GenericFieldType
+{
+    Guid,
+    UInt32,
+    UnicodeString
+};
+
+/// @brief GenericField struct to describe one field of a runtime layout \struct GenericField
+struct GenericField
+{
+    GenericFieldType Type;
+    std::string Name;
+};
+
+/// @brief ResolvedField struct to store a field of a runtime layout with its payload member looked up once \struct ResolvedField
+struct ResolvedField
+{
+    GenericFieldType Type;
+    RpcUuid RpcCallPayload::* Guid = nullptr;
+    uint32_t RpcCallPayload::* UInt32 = nullptr;
+    std::string RpcCallPayload::* String = nullptr;
+};
+
+/// @brief GenericRpcDecoder class to decode payloads by interpreting layouts looked up at runtime \class GenericRpcDecoder
+/// @note This is what decoding looked like before the layouts were compiled, it is kept here as the baseline. decodeByName
+///       matches field names on every event, decode uses the layouts resolved to member pointers at construction.
+class GenericRpcDecoder
+{
+public:
+    GenericRpcDecoder()
+    {
+        const std::vector<GenericField> version0 = {
+            { GenericFieldType::Guid, "InterfaceUuid" }, { GenericFieldType::UInt32, "ProcNum" },
+            { GenericFieldType::UInt32, "Protocol" }, { GenericFieldType::UnicodeString, "NetworkAddress" },
+            { GenericFieldType::UnicodeString, "Endpoint" }
+        };
+        std::vector<GenericField> version1 = version0;
+        version1.push_back({ GenericFieldType::UInt32, "Options" });
+        version1.push_back({ GenericFieldType::UInt32, "AuthenticationLevel" });
+        version1.push_back({ GenericFieldType::UInt32, "AuthenticationService" });
+        version1.push_back({ GenericFieldType::UInt32, "ImpersonationLevel" });
+
+        for (uint16_t eventId : { RpcClientCallStartEventId, RpcServerCallStartEventId })
+        {
+            layouts[{ eventId, 0 }] = version0;
+            layouts[{ eventId, 1 }] = version1;
+        }
+
+        // one slot per (event id, version) up to the newest declared ones, a missing version uses the closest lower one
+        for (const auto& layout : layouts)
+        {
+            maxEventId = (std::max)(maxEventId, layout.first.first);
+            versionCount = (std::max)(versionCount, size_t(layout.first.second) + 1);
+        }
+        resolvedLayouts.resize((size_t(maxEventId) + 1) * versionCount);
+        for (const auto& layout : layouts)
+        {
+            std::vector<ResolvedField>& resolved = resolvedLayouts[layout.first.first * versionCount + layout.first.second];
+            for (const GenericField& field : layout.second)
+            {
+                resolved.push_back(resolve(field));
+            }
+        }
+        for (size_t slot = 0; slot < resolvedLayouts.size(); slot++)
+        {
+            if (slot % versionCount != 0 && resolvedLayouts[slot].empty())
+            {
+                resolvedLayouts[slot] = resolvedLayouts[slot - 1];
+            }
+        }
+    }
+
+    /*!
+     * @brief Decode a payload with the layouts resolved at construction
+     * @param eventId The event id
+     * @param version The event version, the newest layout at or below it is used
+     * @param data The event user data
+     * @param length The user data length in bytes
+     * @param payload The decoded payload
+     * @return bool True if a layout was found and its fixed fields fit, false otherwise
+     */
+    bool decode(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallPayload& payload) const
+    {
+        if (eventId > maxEventId)
+        {
+            return false;
+        }
+        const std::vector<ResolvedField>& layout = resolvedLayouts[eventId * versionCount + (std::min)(size_t(version), versionCount - 1)];
+        if (layout.empty())
+        {
+            return false;
+        }
+
+        payload = RpcCallPayload();
+        size_t offset = 0;
+        bool variable = false;
+        for (const ResolvedField& field : layout)
+        {
+            switch (field.Type)
+            {
+            case GenericFieldType::Guid:
+                if (length - offset < 16)
+                {
+                    return variable;
+                }
+                payload.*field.Guid = readGuid(data + offset);
+                offset += 16;
+                break;
+            case GenericFieldType::UInt32:
+                if (length - offset < 4)
+                {
+                    return variable;
+                }
+                payload.*field.UInt32 = readUInt32(data + offset);
+                offset += 4;
+                break;
+            case GenericFieldType::UnicodeString:
+            {
+                size_t bytesRead = 0;
+                payload.*field.String = readUtf16String(data + offset, length - offset, bytesRead);
+                offset += bytesRead;
+                variable = true;
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+    /*!
+     * @brief Decode a payload, looking up the layout in a map and dispatching every field on its name
+     * @param eventId The event id
+     * @param version The event version, the newest layout at or below it is used
+     * @param data The event user data
+     * @param length The user data length in bytes
+     * @param payload The decoded payload
+     * @return bool True if a layout was found and its fixed fields fit, false otherwise
+     */
+    bool decodeByName(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallPayload& payload) const
+    {
+        auto it = layouts.upper_bound({ eventId, version });
+        if (it == layouts.begin() || (--it)->first.first != eventId)
+        {
+            return false;
+        }
+
+        payload = RpcCallPayload();
+        size_t offset = 0;
+        bool variable = false;
+        for (const GenericField& field : it->second)
+        {
+            switch (field.Type)
+            {
+            case GenericFieldType::Guid:
+                if (length - offset < 16)
+                {
+                    return variable;
+                }
+                store(field.Name, readGuid(data + offset), payload);
+                offset += 16;
+                break;
+            case GenericFieldType::UInt32:
+                if (length - offset < 4)
+                {
+                    return variable;
+                }
+                store(field.Name, readUInt32(data + offset), payload);
+                offset += 4;
+                break;
+            case GenericFieldType::UnicodeString:
+            {
+                size_t bytesRead = 0;
+                store(field.Name, readUtf16String(data + offset, length - offset, bytesRead), payload);
+                offset += bytesRead;
+                variable = true;
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+private:
+    std::map<std::pair<uint16_t, uint8_t>, std::vector<GenericField>> layouts;
+    std::vector<std::vector<ResolvedField>> resolvedLayouts;
+    uint16_t maxEventId = 0;
+    size_t versionCount = 1;
+
+    static ResolvedField resolve(const GenericField& field)
+    {
+        static const std::map<std::string, uint32_t RpcCallPayload::*> uint32Members = {
+            { "ProcNum", &RpcCallPayload::ProcNum }, { "Protocol", &RpcCallPayload::Protocol },
+            { "Options", &RpcCallPayload::Options }, { "AuthenticationLevel", &RpcCallPayload::AuthenticationLevel },
+            { "AuthenticationService", &RpcCallPayload::AuthenticationService },
+            { "ImpersonationLevel", &RpcCallPayload::ImpersonationLevel }
+        };
+        static const std::map<std::string, std::string RpcCallPayload::*> stringMembers = {
+            { "NetworkAddress", &RpcCallPayload::NetworkAddress }, { "Endpoint", &RpcCallPayload::Endpoint }
+        };
+
+        ResolvedField resolved{ field.Type };
+        if (field.Type == GenericFieldType::Guid)
+        {
+            resolved.Guid = field.Name == "InterfaceUuid" ? &RpcCallPayload::InterfaceUuid : nullptr;
+        }
+        else if (field.Type == GenericFieldType::UInt32)
+        {
+            auto it = uint32Members.find(field.Name);
+            resolved.UInt32 = it != uint32Members.end() ? it->second : nullptr;
+        }
+        else
+        {
+            auto it = stringMembers.find(field.Name);
+            resolved.String = it != stringMembers.end() ? it->second : nullptr;
+        }
+
+        if (!resolved.Guid && !resolved.UInt32 && !resolved.String)
+        {
+            throw std::runtime_error("Unknown payload field " + field.Name);
+        }
+        return resolved;
+    }
+
+    static void store(const std::string& name, const RpcUuid& value, RpcCallPayload& payload)
+    {
+        if (name == "InterfaceUuid")
+        {
+            payload.InterfaceUuid = value;
+        }
+    }
+
+    static void store(const std::string& name, uint32_t value, RpcCallPayload& payload)
+    {
+        if (name == "ProcNum")
+        {
+            payload.ProcNum = value;
+        }
+        else if (name == "Protocol")
+        {
+            payload.Protocol = value;
+        }
+        else if (name == "Options")
+        {
+            payload.Options = value;
+        }
+        else if (name == "AuthenticationLevel")
+        {
+            payload.AuthenticationLevel = value;
+        }
+        else if (name == "AuthenticationService")
+        {
+            payload.AuthenticationService = value;
+        }
+        else if (name == "ImpersonationLevel")
+        {
+            payload.ImpersonationLevel = value;
+        }
+    }
+
+    static void store(const std::string& name, std::string value, RpcCallPayload& payload)
+    {
+        if (name == "NetworkAddress")
+        {
+            payload.NetworkAddress = std::move(value);
+        }
+        else if (name == "Endpoint")
+        {
+            payload.Endpoint = std::move(value);
+        }
+    }
+};
+
+/// @brief EncodedEvent struct to store one synthetic event as ETW would deliver it \struct EncodedEvent
+struct EncodedEvent
+{
+    uint16_t EventId;
+    uint8_t Version;
+    std::vector<uint8_t> Data;
+};
+
+static uint64_t payloadChecksum(const RpcCallPayload& payload)
+{
+    return payload.InterfaceUuid.High ^ payload.InterfaceUuid.Low ^ payload.ProcNum ^ (uint64_t(payload.Protocol) << 8)
+        ^ payload.NetworkAddress.size() ^ (payload.Endpoint.size() << 16) ^ (uint64_t(payload.AuthenticationLevel) << 24)
+        ^ (uint64_t(payload.AuthenticationService) << 32) ^ (uint64_t(payload.ImpersonationLevel) << 40);
+}
+
+static bool samePayload(const RpcCallPayload& a, const RpcCallPayload& b)
+{
+    return a.InterfaceUuid == b.InterfaceUuid && a.ProcNum == b.ProcNum && a.Protocol == b.Protocol
+        && a.NetworkAddress == b.NetworkAddress && a.Endpoint == b.Endpoint && a.Options == b.Options
+        && a.AuthenticationLevel == b.AuthenticationLevel && a.AuthenticationService == b.AuthenticationService
+        && a.ImpersonationLevel == b.ImpersonationLevel;
+}
+
+template <typename Decode>
+static BenchmarkResult benchmarkDecoder(const std::string& name, const std::vector<EncodedEvent>& events, double baselineSeconds, Decode decode)
+{
+    uint64_t checksum = 0;
+    size_t decoded = 0;
+    RpcCallPayload payload;
+    Stopwatch stopwatch;
+    for (const auto& event : events)
+    {
+        if (decode(event, payload))
+        {
+            checksum += payloadChecksum(payload);
+            decoded++;
+        }
+    }
+    const double seconds = stopwatch.seconds();
+
+    BenchmarkResult result{ name, events.size(), seconds };
+    result.Metrics["decoded"] = static_cast<double>(decoded);
+    result.Metrics["checksum"] = static_cast<double>(checksum % (uint64_t(1) << 52));
+    if (baselineSeconds > 0.0)
+    {
+        result.Metrics["speedup_vs_generic"] = seconds > 0.0 ? baselineSeconds / seconds : 0.0;
+    }
+    return result;
+}
+
+void runDecodeBenchmarks(BenchmarkSuite& suite)
+{
+    static const char* const names[] = { "decode.generic_by_name", "decode.generic", "decode.generated", "decode.generated_direct" };
+    bool anyEnabled = false;
+    for (const char* name : names)
+    {
+        anyEnabled = anyEnabled || suite.enabled(name);
+    }
+    if (!anyEnabled)
+    {
+        return;
+    }
+
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    // a mix of client and server calls from hosts that emit either version, like a capture across OS builds
+    const std::vector<SyntheticCall> calls = generator.calls(suite.scaled(500000), 3);
+    std::vector<EncodedEvent> events;
+    events.reserve(calls.size());
+    for (size_t i = 0; i < calls.size(); i++)
+    {
+        const uint16_t eventId = i % 4 == 0 ? RpcServerCallStartEventId : RpcClientCallStartEventId;
+        const uint8_t version = i % 3 == 0 ? 0 : 1;
+        events.push_back(EncodedEvent{ eventId, version, WorkloadGenerator::encodePayload(calls[i], version) });
+    }
+
+    const GenericRpcDecoder generic;
+    size_t mismatches = 0;
+    size_t byNameMismatches = 0;
+    RpcCallPayload genericPayload;
+    RpcCallPayload byNamePayload;
+    RpcCallPayload generatedPayload;
+    for (const auto& event : events)
+    {
+        const bool genericDecoded = generic.decode(event.EventId, event.Version, event.Data.data(), event.Data.size(), genericPayload);
+        const bool byNameDecoded = generic.decodeByName(event.EventId, event.Version, event.Data.data(), event.Data.size(), byNamePayload);
+        const bool generatedDecoded = decodeRpcEvent(event.EventId, event.Version, event.Data.data(), event.Data.size(), generatedPayload);
+        if (genericDecoded != generatedDecoded || (genericDecoded && !samePayload(genericPayload, generatedPayload)))
+        {
+            mismatches++;
+        }
+        if (byNameDecoded != genericDecoded || (byNameDecoded && !samePayload(byNamePayload, genericPayload)))
+        {
+            byNameMismatches++;
+        }
+    }
+    // every run checks that the decoders agree, a speedup from decoding less would be no speedup
+    double byNameSeconds = 0.0;
+    if (suite.enabled("decode.generic_by_name"))
+    {
+        BenchmarkResult result = benchmarkDecoder("decode.generic_by_name", events, 0.0,
+            [&generic](const EncodedEvent& event, RpcCallPayload& payload)
+            {
+                return generic.decodeByName(event.EventId, event.Version, event.Data.data(), event.Data.size(), payload);
+            });
+        byNameSeconds = result.Seconds;
+        result.Metrics["mismatches_vs_generic"] = static_cast<double>(byNameMismatches);
+        suite.report(result);
+    }
+
+    // the baseline the generated decoders are compared with, layouts and members are resolved once, not per event
+    double genericSeconds = 0.0;
+    if (suite.enabled("decode.generic"))
+    {
+        BenchmarkResult result = benchmarkDecoder("decode.generic", events, 0.0,
+            [&generic](const EncodedEvent& event, RpcCallPayload& payload)
+            {
+                return generic.decode(event.EventId, event.Version, event.Data.data(), event.Data.size(), payload);
+            });
+        genericSeconds = result.Seconds;
+        if (byNameSeconds > 0.0)
+        {
+            result.Metrics["speedup_vs_by_name"] = result.Seconds > 0.0 ? byNameSeconds / result.Seconds : 0.0;
+        }
+        suite.report(result);
+    }
+
+    if (suite.enabled("decode.generated"))
+    {
+        BenchmarkResult result = benchmarkDecoder("decode.generated", events, genericSeconds,
+            [](const EncodedEvent& event, RpcCallPayload& payload)
+            {
+                return decodeRpcEvent(event.EventId, event.Version, event.Data.data(), event.Data.size(), payload);
+            });
+        result.Metrics["mismatches_vs_generic"] = static_cast<double>(mismatches);
+        suite.report(result);
+    }
+
+    // the floor without dispatch, the newest layout reads every event of the mix
+    if (suite.enabled("decode.generated_direct"))
+    {
+        using Newest = RpcEventSchema<RpcClientCallStartEventId, 1,
+            RpcInterfaceUuidField, RpcProcNumField, RpcProtocolField, RpcNetworkAddressField, RpcEndpointField,
+            RpcOptionsField, RpcAuthenticationLevelField, RpcAuthenticationServiceField, RpcImpersonationLevelField>;
+        suite.report(benchmarkDecoder("decode.generated_direct", events, genericSeconds,
+            [](const EncodedEvent& event, RpcCallPayload& payload)
+            {
+                return Newest::decode(event.Data.data(), event.Data.size(), payload);
+            }));
+    }
+}
@@ -0,0 +1,245 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventSchema.h"
+#include "../include/RpcEventIngest.h"
+#include "../include/RpcEventPipeline.h"
+#include "../include/RpcLoadShedder.h"
+#include "../include/BoundedQueue.h"
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+
+/// @brief SyntheticProcessInfoProvider class to attribute synthetic PIDs without touching the system \class SyntheticProcessInfoProvider
+class SyntheticProcessInfoProvider : public ProcessInfoProvider
+{
+public:
+    bool query(uint32_t processId, ProcessAttribution& attribution) override
+    {
+        attribution.ImagePath = "C:\\Windows\\System32\\process" + std::to_string(processId) + ".exe";
+        attribution.ServiceName = processId % 3 == 0 ? "SynthSvc" + std::to_string(processId) : std::string();
+        attribution.StartTime = 1;
+        return true;
+    }
+};
+
+static std::vector<std::vector<uint8_t>> encodeCalls(const std::vector<SyntheticCall>& calls)
+{
+    std::vector<std::vector<uint8_t>> payloads;
+    payloads.reserve(calls.size());
+    for (const auto& call : calls)
+    {
+        payloads.push_back(WorkloadGenerator::encodePayload(call));
+    }
+    return payloads;
+}
+
+/*!
+ * @brief Build the pipeline RpcMonitor's processing thread runs, attributing the synthetic PIDs
+ * @param config The RPC servers configuration
+ * @return std::unique_ptr<RpcEventPipeline> The pipeline
+ */
+static std::unique_ptr<RpcEventPipeline> makePipeline(const RpcServersConfig& config)
+{
+    return std::make_unique<RpcEventPipeline>(std::make_shared<RpcServersDatabase>(config), std::make_unique<SyntheticProcessInfoProvider>());
+}
+
+static RpcCallRecord decodeRecord(const SyntheticCall& call, const std::vector<uint8_t>& payload)
+{
+    RpcCallRecord record;
+    record.ProcessId = call.ProcessId;
+    record.Timestamp = call.Timestamp;
+    decodeRpcCallPayload(payload.data(), payload.size(), record.Payload);
+    return record;
+}
+
+static void benchmarkPipeline(BenchmarkSuite& suite, const std::vector<SyntheticCall>& calls,
+    const std::vector<std::vector<uint8_t>>& payloads, const RpcServersConfig& config)
+{
+    std::unique_ptr<RpcEventPipeline> pipeline = makePipeline(config);
+    LatencyRecorder latencies;
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < payloads.size(); i++)
+    {
+        Stopwatch eventStopwatch;
+        pipeline->process(decodeRecord(calls[i], payloads[i]));
+        latencies.record(eventStopwatch.nanoseconds());
+    }
+
+    const ProcessAttributionCache& processCache = pipeline->getProcessCache();
+    const double attributions = static_cast<double>(processCache.hits() + processCache.misses());
+    BenchmarkResult result{ "pipeline.throughput", calls.size(), stopwatch.seconds() };
+    result.Metrics["events_stored"] = static_cast<double>(pipeline->size());
+    result.Metrics["process_hit_rate"] = static_cast<double>(processCache.hits()) / attributions;
+    latencies.report(result);
+    suite.report(result);
+}
+
+static double measureCapacity(const std::vector<SyntheticCall>& calls, const std::vector<std::vector<uint8_t>>& payloads, const RpcServersConfig& config)
+{
+    std::unique_ptr<RpcEventPipeline> pipeline = makePipeline(config);
+    const size_t count = (std::min)(calls.size(), size_t(50000));
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < count; i++)
+    {
+        pipeline->process(decodeRecord(calls[i], payloads[i]));
+    }
+    return static_cast<double>(count) / stopwatch.seconds();
+}
+
+static void benchmarkReplay(BenchmarkSuite& suite, const std::string& name, const std::vector<SyntheticCall>& calls,
+    const std::vector<std::vector<uint8_t>>& payloads, const RpcServersConfig& config, const RpcSamplingOptions& sampling,
+    double capacity)
+{
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    // offer four times what the processing thread can handle, paced like a live session would deliver it
+    const double offeredRate = 4.0 * capacity;
+    const double duration = (std::max)(0.25, suite.options().Scale);
+
+    std::unique_ptr<RpcEventPipeline> pipeline = makePipeline(config);
+    RpcLoadShedder shedder(sampling);
+    BoundedQueue<RpcIngestRecord> queue(4 * sampling.HighWatermark);
+    std::unordered_map<RpcUuid, double, RpcUuidHash> weightedCalls;
+    uint64_t busyNanoseconds = 0;
+
+    std::thread worker([&]() {
+        std::vector<RpcIngestRecord> batch;
+        while (queue.popAll(batch, std::chrono::milliseconds(50)))
+        {
+            Stopwatch stopwatch;
+            for (const auto& record : batch)
+            {
+                pipeline->process(record);
+                const RpcCallRecord& call = std::get<RpcCallRecord>(record);
+                weightedCalls[call.Payload.InterfaceUuid] += call.Weight;
+            }
+            busyNanoseconds += stopwatch.nanoseconds();
+        }
+    });
+
+    // the producer stands in for the ETW thread, its CPU time is what a callback costs the traced system
+    ThreadCpuStopwatch producerCpu;
+    Stopwatch stopwatch;
+    const auto start = std::chrono::steady_clock::now();
+    const size_t offered = static_cast<size_t>(offeredRate * duration);
+    size_t maxDepth = 0;
+    size_t next = 0;
+    while (next < offered)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const size_t due = (std::min)(offered, static_cast<size_t>(std::chrono::duration<double>(now - start).count() * offeredRate) + 1);
+        for (; next < due; next++)
+        {
+            const size_t index = next % calls.size();
+            RpcCallRecord record;
+            record.ProcessId = calls[index].ProcessId;
+            record.Timestamp = calls[index].Timestamp;
+            ingestRpcEvent(shedder, queue, RpcClientCallStartEventId, 1, payloads[index].data(), payloads[index].size(), std::move(record), now);
+        }
+        maxDepth = (std::max)(maxDepth, queue.size());
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    const double producerSeconds = stopwatch.seconds();
+    const uint64_t producerCpuNanoseconds = producerCpu.nanoseconds();
+    queue.close();
+    worker.join();
+    const double seconds = stopwatch.seconds();
+
+    // the weighted per interface counts should match what was offered, whatever was dropped
+    std::unordered_map<RpcUuid, double, RpcUuidHash> offeredCalls;
+    for (size_t i = 0; i < offered; i++)
+    {
+        offeredCalls[calls[i % calls.size()].InterfaceUuid] += 1.0;
+    }
+    double weightedTotal = 0.0;
+    for (const auto& entry : weightedCalls)
+    {
+        weightedTotal += entry.second;
+    }
+    std::vector<std::pair<RpcUuid, double>> topInterfaces(offeredCalls.begin(), offeredCalls.end());
+    const size_t topCount = (std::min)(size_t(10), topInterfaces.size());
+    std::partial_sort(topInterfaces.begin(), topInterfaces.begin() + topCount, topInterfaces.end(),
+        [](const std::pair<RpcUuid, double>& a, const std::pair<RpcUuid, double>& b) { return a.second > b.second; });
+    double topMaxError = 0.0;
+    for (size_t i = 0; i < topCount; i++)
+    {
+        topMaxError = (std::max)(topMaxError, std::fabs(weightedCalls[topInterfaces[i].first] - topInterfaces[i].second) / topInterfaces[i].second);
+    }
+
+    BenchmarkResult result{ name, offered, seconds };
+    result.Metrics["capacity_per_sec"] = capacity;
+    result.Metrics["offered_per_sec"] = static_cast<double>(offered) / producerSeconds;
+    result.Metrics["processed"] = static_cast<double>(pipeline->size());
+    result.Metrics["sampled"] = static_cast<double>(shedder.sampledEvents());
+    result.Metrics["shed"] = static_cast<double>(shedder.shedEvents());
+    result.Metrics["worker_busy_fraction"] = static_cast<double>(busyNanoseconds) * 1e-9 / seconds;
+    result.Metrics["producer_cpu_fraction"] = static_cast<double>(producerCpuNanoseconds) * 1e-9 / producerSeconds;
+    result.Metrics["producer_cpu_ns_per_event"] = static_cast<double>(producerCpuNanoseconds) / static_cast<double>(offered);
+    result.Metrics["drain_seconds"] = seconds - producerSeconds;
+    result.Metrics["max_queue_depth"] = static_cast<double>(maxDepth);
+    result.Metrics["final_rate"] = shedder.rate();
+    result.Metrics["weighted_total_error"] = std::fabs(weightedTotal - static_cast<double>(offered)) / static_cast<double>(offered);
+    result.Metrics["top_interface_max_error"] = topMaxError;
+    suite.report(result);
+}
+
+void runEventBenchmarks(BenchmarkSuite& suite)
+{
+    static const char* const replayNames[] = {
+        "replay.overload.unsampled", "replay.overload.uniform", "replay.overload.adaptive"
+    };
+    const bool pipelineEnabled = suite.enabled("pipeline.throughput");
+    bool replayEnabled = false;
+    for (const char* name : replayNames)
+    {
+        replayEnabled = replayEnabled || suite.enabled(name);
+    }
+    if (!pipelineEnabled && !replayEnabled)
+    {
+        return;
+    }
+
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    const std::vector<SyntheticCall> calls = generator.calls(suite.scaled(500000), 3);
+    const std::vector<std::vector<uint8_t>> payloads = encodeCalls(calls);
+
+    const std::string filePath = suite.options().WorkDir + "/rpc_servers_pipeline.json";
+    generator.writeRpcServersFile(filePath, 0, generator.interfaces().size(), 0);
+    RpcServersConfig config = RpcServersConfig::load(filePath);
+    std::filesystem::remove(filePath);
+
+    if (pipelineEnabled)
+    {
+        benchmarkPipeline(suite, calls, payloads, config);
+    }
+
+    if (!replayEnabled)
+    {
+        return;
+    }
+    const double capacity = measureCapacity(calls, payloads, config);
+
+    // only the full queue drops events, every admitted event is processed
+    RpcSamplingOptions unsampled;
+    unsampled.Adaptive = false;
+    unsampled.InterfaceRate = 0.0;
+    benchmarkReplay(suite, "replay.overload.unsampled", calls, payloads, config, unsampled, capacity);
+
+    RpcSamplingOptions uniform;
+    uniform.Adaptive = false;
+    uniform.UniformRate = 0.2;
+    uniform.InterfaceRate = 0.0;
+    benchmarkReplay(suite, "replay.overload.uniform", calls, payloads, config, uniform, capacity);
+
+    benchmarkReplay(suite, "replay.overload.adaptive", calls, payloads, config, RpcSamplingOptions(), capacity);
+}
@@ -0,0 +1,189 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/RpcEventStore.h"
+
+static size_t scanCount(const RpcEventSnapshot& snapshot, const RpcEventQuery& query)
+{
+    // what answering a query over the copied event list used to cost
+    const RowSnapshot<RpcEvent>& rows = snapshot.rows();
+    size_t matches = 0;
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        const RpcEvent& event = rows[i];
+        if (event.Timestamp < query.From || event.Timestamp > query.To)
+        {
+            continue;
+        }
+        if (query.InterfaceUuid && event.InterfaceUuid != *query.InterfaceUuid)
+        {
+            continue;
+        }
+        if (query.ProcessId && event.ProcessId != *query.ProcessId)
+        {
+            continue;
+        }
+        matches++;
+    }
+    return matches;
+}
+
+static void benchmarkQueries(BenchmarkSuite& suite, const std::string& name, const RpcEventSnapshot& snapshot, const std::vector<RpcEventQuery>& queries)
+{
+    if (!suite.enabled(name))
+    {
+        return;
+    }
+
+    size_t matches = 0;
+    LatencyRecorder latencies;
+    Stopwatch stopwatch;
+    for (const auto& query : queries)
+    {
+        Stopwatch queryStopwatch;
+        for (const RpcEvent& event : snapshot.query(query))
+        {
+            doNotOptimize(event);
+            matches++;
+        }
+        latencies.record(queryStopwatch.nanoseconds());
+    }
+    const double seconds = stopwatch.seconds();
+
+    // the scan is slow by design, a few queries are enough to compare against
+    const size_t scannedQueries = (std::min)(size_t(3), queries.size());
+    size_t scanMatches = 0;
+    size_t indexedMatches = 0;
+    Stopwatch scanStopwatch;
+    for (size_t i = 0; i < scannedQueries; i++)
+    {
+        scanMatches += scanCount(snapshot, queries[i]);
+    }
+    const double scanSeconds = scanStopwatch.seconds();
+    for (size_t i = 0; i < scannedQueries; i++)
+    {
+        auto range = snapshot.query(queries[i]);
+        indexedMatches += static_cast<size_t>(std::distance(range.begin(), range.end()));
+    }
+
+    BenchmarkResult result{ name, queries.size(), seconds };
+    result.Metrics["events"] = static_cast<double>(snapshot.size());
+    result.Metrics["matches"] = static_cast<double>(matches);
+    result.Metrics["matches_agree_with_scan"] = scanMatches == indexedMatches ? 1.0 : 0.0;
+    result.Metrics["scan_ms_per_query"] = scanSeconds * 1e3 / static_cast<double>(scannedQueries);
+    result.Metrics["speedup_vs_scan"] = seconds > 0.0 ? (scanSeconds / static_cast<double>(scannedQueries)) / (seconds / static_cast<double>(queries.size())) : 0.0;
+    latencies.report(result);
+    suite.report(result);
+}
+
+static std::vector<RpcEventQuery> windowQueries(uint64_t first, uint64_t last, uint64_t window, size_t count, const RpcEventQuery& filter)
+{
+    std::vector<RpcEventQuery> queries;
+    const uint64_t span = last - first > window ? last - first - window : 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        RpcEventQuery query = filter;
+        query.From = first + span * i / count;
+        query.To = query.From + window;
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+void runQueryBenchmarks(BenchmarkSuite& suite)
+{
+    static const char* const names[] = {
+        "query.append", "query.snapshot", "query.time_window", "query.interface_window",
+        "query.cold_interface_all", "query.process_window", "query.interface_and_process"
+    };
+    bool anyEnabled = false;
+    for (const char* name : names)
+    {
+        anyEnabled = anyEnabled || suite.enabled(name);
+    }
+    if (!anyEnabled)
+    {
+        return;
+    }
+
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    // a million events by default, --scale 50 gives the 50 million the store is designed for (about 3.5 GB)
+    // the calls are generated in batches so they never all live at once
+    const size_t eventCount = suite.scaled(1000000);
+    const size_t batchSize = 1000000;
+    RpcEventStore store;
+    double appendSeconds = 0.0;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    uint32_t firstProcessId = 0;
+    for (size_t batch = 0; store.size() < eventCount; batch++)
+    {
+        const std::vector<SyntheticCall> calls = generator.calls((std::min)(batchSize, eventCount - store.size()), 11 + batch);
+        const uint64_t batchStart = calls.front().Timestamp - 1;
+        if (batch == 0)
+        {
+            first = calls.front().Timestamp;
+            firstProcessId = calls.front().ProcessId;
+            last = batchStart;
+        }
+
+        Stopwatch appendStopwatch;
+        for (const auto& call : calls)
+        {
+            RpcEvent event;
+            event.ProcessId = call.ProcessId;
+            event.Timestamp = last + (call.Timestamp - batchStart);
+            event.InterfaceUuid = call.InterfaceUuid;
+            event.ProcedureNum = static_cast<uint16_t>(call.ProcNum);
+            store.append(event, call.Endpoint);
+        }
+        appendSeconds += appendStopwatch.seconds();
+        last += calls.back().Timestamp - batchStart;
+    }
+
+    if (suite.enabled("query.append"))
+    {
+        BenchmarkResult result{ "query.append", store.size(), appendSeconds };
+        result.Metrics["segments"] = static_cast<double>((store.size() + RpcEventStore::SegmentRows - 1) / RpcEventStore::SegmentRows);
+        result.Metrics["bytes_per_event"] = static_cast<double>(store.bytes()) / static_cast<double>(store.size());
+        result.Metrics["row_bytes"] = static_cast<double>(sizeof(RpcEvent));
+        suite.report(result);
+    }
+
+    RpcEventSnapshot snapshot;
+    if (suite.enabled("query.snapshot"))
+    {
+        const size_t snapshots = 100;
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < snapshots; i++)
+        {
+            store.snapshot(snapshot);
+        }
+        suite.report(BenchmarkResult{ "query.snapshot", snapshots, stopwatch.seconds() });
+    }
+    store.snapshot(snapshot);
+
+    const uint64_t window = (last - first) / 100;
+    const size_t queryCount = 100;
+
+    RpcEventQuery timeOnly;
+    benchmarkQueries(suite, "query.time_window", snapshot, windowQueries(first, last, window, queryCount, timeOnly));
+
+    RpcEventQuery hotInterface;
+    hotInterface.InterfaceUuid = generator.interfaces()[0];
+    benchmarkQueries(suite, "query.interface_window", snapshot, windowQueries(first, last, window, queryCount, hotInterface));
+
+    RpcEventQuery coldInterface;
+    coldInterface.InterfaceUuid = generator.interfaces()[generator.interfaces().size() / 2];
+    benchmarkQueries(suite, "query.cold_interface_all", snapshot, std::vector<RpcEventQuery>(queryCount, coldInterface));
+
+    RpcEventQuery process;
+    process.ProcessId = firstProcessId;
+    benchmarkQueries(suite, "query.process_window", snapshot, windowQueries(first, last, window, queryCount, process));
+
+    RpcEventQuery interfaceAndProcess = hotInterface;
+    interfaceAndProcess.ProcessId = firstProcessId;
+    benchmarkQueries(suite, "query.interface_and_process", snapshot, windowQueries(first, last, 10 * window, queryCount, interfaceAndProcess));
+}
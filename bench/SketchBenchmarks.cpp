@@ -0,0 +1,222 @@
+#include "Benchmark.h"
+#include "WorkloadGenerator.h"
+#include "../include/RpcTrafficSketch.h"
+#include "../include/HyperLogLog.h"
+#include "../include/SpaceSaving.h"
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+static std::vector<RpcCallKey> toCallKeys(const std::vector<SyntheticCall>& calls)
+{
+    std::vector<RpcCallKey> keys;
+    keys.reserve(calls.size());
+    for (const auto& call : calls)
+    {
+        RpcCallKey key;
+        key.InterfaceUuid = call.InterfaceUuid;
+        key.ProcedureNum = static_cast<int>(call.ProcNum);
+        key.ProcessId = static_cast<int>(call.ProcessId);
+        key.Endpoint = call.Endpoint;
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+/*!
+ * @brief Estimate the memory of an unordered container the way SpaceSaving::bytes does
+ * @param container The unordered_map or unordered_set
+ * @return size_t The byte count, without memory the elements own on the heap
+ */
+template <typename Container>
+static size_t unorderedBytes(const Container& container)
+{
+    return container.bucket_count() * sizeof(void*) + container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void*));
+}
+
+static void benchmarkHeavyHitters(BenchmarkSuite& suite, const std::vector<RpcCallKey>& keys)
+{
+    if (!suite.enabled("sketch.exact_counting") && !suite.enabled("sketch.space_saving"))
+    {
+        return;
+    }
+
+    const size_t topCount = 20;
+
+    // exact counting is the baseline: memory grows with every distinct stream
+    Stopwatch exactStopwatch;
+    std::unordered_map<RpcCallKey, uint64_t, RpcCallKeyHash> exactCounts;
+    for (const auto& key : keys)
+    {
+        exactCounts[key]++;
+    }
+    const double exactSeconds = exactStopwatch.seconds();
+
+    std::vector<std::pair<RpcCallKey, uint64_t>> exactTop(exactCounts.begin(), exactCounts.end());
+    const size_t keep = (std::min)(topCount, exactTop.size());
+    std::partial_sort(exactTop.begin(), exactTop.begin() + keep, exactTop.end(),
+        [](const std::pair<RpcCallKey, uint64_t>& a, const std::pair<RpcCallKey, uint64_t>& b) { return a.second > b.second; });
+    exactTop.resize(keep);
+
+    if (suite.enabled("sketch.exact_counting"))
+    {
+        BenchmarkResult result{ "sketch.exact_counting", keys.size(), exactSeconds };
+        result.Metrics["distinct_streams"] = static_cast<double>(exactCounts.size());
+        suite.report(result);
+    }
+
+    if (!suite.enabled("sketch.space_saving"))
+    {
+        return;
+    }
+
+    // the summary on its own, RpcTrafficSketch::add also feeds the per interface HyperLogLogs
+    SpaceSaving<RpcCallKey, RpcCallKeyHash> heavyHitters(1024);
+    Stopwatch sketchStopwatch;
+    for (const auto& key : keys)
+    {
+        heavyHitters.add(key);
+    }
+    const double sketchSeconds = sketchStopwatch.seconds();
+
+    const auto reported = heavyHitters.top(topCount);
+    size_t recalled = 0;
+    double maxRelativeError = 0.0;
+    for (const auto& expected : exactTop)
+    {
+        for (const auto& counter : reported)
+        {
+            if (counter.Item == expected.first)
+            {
+                recalled++;
+                const double exact = static_cast<double>(expected.second);
+                maxRelativeError = (std::max)(maxRelativeError, std::fabs(counter.Count - exact) / exact);
+                break;
+            }
+        }
+    }
+
+    const size_t exactBytes = unorderedBytes(exactCounts);
+    const size_t sketchBytes = heavyHitters.bytes();
+    BenchmarkResult result{ "sketch.space_saving", keys.size(), sketchSeconds };
+    result.Metrics["top_recall"] = keep ? static_cast<double>(recalled) / static_cast<double>(keep) : 1.0;
+    result.Metrics["top_max_relative_error"] = maxRelativeError;
+    result.Metrics["error_bound"] = heavyHitters.errorBound();
+    result.Metrics["speedup_vs_exact"] = sketchSeconds > 0.0 ? exactSeconds / sketchSeconds : 0.0;
+    result.Metrics["sketch_bytes"] = static_cast<double>(sketchBytes);
+    result.Metrics["exact_bytes"] = static_cast<double>(exactBytes);
+    result.Metrics["memory_ratio_vs_exact"] = sketchBytes ? static_cast<double>(exactBytes) / static_cast<double>(sketchBytes) : 0.0;
+    suite.report(result);
+}
+
+static void benchmarkCardinality(BenchmarkSuite& suite, const std::vector<RpcCallKey>& keys, const std::vector<RpcUuid>& interfaces)
+{
+    if (!suite.enabled("sketch.hyperloglog"))
+    {
+        return;
+    }
+
+    // one HyperLogLog per interface fed like RpcTrafficSketch::add does, without its heavy hitter summary
+    const int precision = 10;
+    std::unordered_map<RpcUuid, HyperLogLog, RpcUuidHash> sketches;
+    Stopwatch stopwatch;
+    for (const auto& key : keys)
+    {
+        auto it = sketches.find(key.InterfaceUuid);
+        if (it == sketches.end())
+        {
+            it = sketches.emplace(key.InterfaceUuid, HyperLogLog(precision)).first;
+        }
+        it->second.add(HyperLogLog::mix(rpcEndpointHash(key.Endpoint)));
+    }
+    const double seconds = stopwatch.seconds();
+
+    // exact endpoint sets of every interface are the baseline for both accuracy and memory
+    Stopwatch exactStopwatch;
+    std::unordered_map<RpcUuid, std::unordered_set<std::string>, RpcUuidHash> exactEndpoints;
+    for (const auto& key : keys)
+    {
+        exactEndpoints[key.InterfaceUuid].insert(key.Endpoint);
+    }
+    const double exactSeconds = exactStopwatch.seconds();
+
+    size_t exactBytes = unorderedBytes(exactEndpoints);
+    for (const auto& entry : exactEndpoints)
+    {
+        exactBytes += unorderedBytes(entry.second);
+    }
+    const size_t sketchBytes = unorderedBytes(sketches) + sketches.size() * (size_t(1) << precision);
+
+    // compare the estimates of the hottest interfaces
+    const size_t checkedInterfaces = (std::min)(size_t(10), interfaces.size());
+    double maxRelativeError = 0.0;
+    for (size_t i = 0; i < checkedInterfaces; i++)
+    {
+        auto exact = exactEndpoints.find(interfaces[i]);
+        auto sketch = sketches.find(interfaces[i]);
+        if (exact == exactEndpoints.end() || sketch == sketches.end())
+        {
+            continue;
+        }
+        const double count = static_cast<double>(exact->second.size());
+        maxRelativeError = (std::max)(maxRelativeError, std::fabs(sketch->second.estimate() - count) / count);
+    }
+
+    BenchmarkResult result{ "sketch.hyperloglog", keys.size(), seconds };
+    result.Metrics["checked_interfaces"] = static_cast<double>(checkedInterfaces);
+    result.Metrics["max_relative_error"] = maxRelativeError;
+    result.Metrics["speedup_vs_exact"] = seconds > 0.0 ? exactSeconds / seconds : 0.0;
+    result.Metrics["sketch_bytes"] = static_cast<double>(sketchBytes);
+    result.Metrics["exact_bytes"] = static_cast<double>(exactBytes);
+    result.Metrics["memory_ratio_vs_exact"] = sketchBytes ? static_cast<double>(exactBytes) / static_cast<double>(sketchBytes) : 0.0;
+    suite.report(result);
+}
+
+static void benchmarkMerge(BenchmarkSuite& suite, const WorkloadGenerator& generator)
+{
+    if (!suite.enabled("sketch.merge"))
+    {
+        return;
+    }
+
+    const size_t partCount = 8;
+    std::vector<RpcTrafficSketch> parts(partCount);
+    for (size_t i = 0; i < partCount; i++)
+    {
+        for (const auto& key : toCallKeys(generator.calls(suite.scaled(25000), 100 + i)))
+        {
+            parts[i].add(key);
+        }
+    }
+
+    Stopwatch stopwatch;
+    RpcTrafficSketch merged;
+    for (const auto& part : parts)
+    {
+        merged.merge(part);
+    }
+
+    BenchmarkResult result{ "sketch.merge", partCount, stopwatch.seconds() };
+    result.Metrics["total_calls"] = merged.totalCalls();
+    result.Metrics["error_bound"] = merged.errorBound();
+    suite.report(result);
+}
+
+void runSketchBenchmarks(BenchmarkSuite& suite)
+{
+    if (!suite.enabled("sketch.exact_counting") && !suite.enabled("sketch.space_saving")
+        && !suite.enabled("sketch.hyperloglog") && !suite.enabled("sketch.merge"))
+    {
+        return;
+    }
+
+    WorkloadOptions options;
+    options.Seed = suite.options().Seed;
+    WorkloadGenerator generator(options);
+
+    // keys are built up front so no benchmark times their string allocations
+    const std::vector<RpcCallKey> keys = toCallKeys(generator.calls(suite.scaled(500000), 7));
+    benchmarkHeavyHitters(suite, keys);
+    benchmarkCardinality(suite, keys, generator.interfaces());
+    benchmarkMerge(suite, generator);
+}
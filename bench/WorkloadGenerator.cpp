@@ -0,0 +1,237 @@
+#include "WorkloadGenerator.h"
+#include "../externals/json/single_include/nlohmann/json.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+uint64_t SplitMix64::next()
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+double SplitMix64::nextDouble()
+{
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t SplitMix64::below(uint64_t bound)
+{
+    return bound == 0 ? 0 : next() % bound;
+}
+
+ZipfDistribution::ZipfDistribution(size_t count, double skew)
+{
+    cdf.reserve((std::max)(count, size_t(1)));
+    double sum = 0.0;
+    for (size_t rank = 1; rank <= (std::max)(count, size_t(1)); rank++)
+    {
+        sum += 1.0 / std::pow(static_cast<double>(rank), skew);
+        cdf.push_back(sum);
+    }
+    for (auto& value : cdf)
+    {
+        value /= sum;
+    }
+}
+
+size_t ZipfDistribution::operator()(SplitMix64& rng) const
+{
+    const double u = rng.nextDouble();
+    const size_t rank = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+    return (std::min)(rank, cdf.size() - 1);
+}
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadOptions& options) : m_options(options)
+{
+    SplitMix64 rng(options.Seed);
+    m_interfaces.reserve(options.InterfaceCount);
+    m_procedureCounts.reserve(options.InterfaceCount);
+    for (size_t i = 0; i < options.InterfaceCount; i++)
+    {
+        RpcUuid uuid;
+        uuid.High = rng.next();
+        uuid.Low = rng.next();
+        m_interfaces.push_back(uuid);
+        m_procedureCounts.push_back(static_cast<uint32_t>(1 + rng.below((std::max)(options.MaxProcedures, size_t(1)))));
+    }
+}
+
+const std::vector<RpcUuid>& WorkloadGenerator::interfaces() const
+{
+    return m_interfaces;
+}
+
+size_t WorkloadGenerator::procedureCount(size_t interfaceIndex) const
+{
+    return m_procedureCounts[interfaceIndex];
+}
+
+std::string WorkloadGenerator::rpcServersJson(size_t first, size_t count, uint64_t variant) const
+{
+    SplitMix64 rng(m_options.Seed ^ (variant * 0x2545f4914f6cdd1dULL));
+    json root = json::array();
+    for (size_t n = 0; n < count && !m_interfaces.empty(); n++)
+    {
+        const size_t index = (first + n) % m_interfaces.size();
+        const std::string uuid = m_interfaces[index].toString();
+
+        // a few interfaces of a variant build gain procedures or rename one, the rest is identical
+        size_t procedureCount = m_procedureCounts[index];
+        const bool changed = variant != 0 && rng.below(20) == 0;
+        if (changed)
+        {
+            procedureCount += 1 + rng.below(3);
+        }
+
+        json procedures = json::array();
+        for (size_t opnum = 0; opnum < procedureCount; opnum++)
+        {
+            std::string name = "Proc" + std::to_string(index) + "_" + std::to_string(opnum);
+            if (changed && opnum == 0)
+            {
+                name += "_v" + std::to_string(variant);
+            }
+            procedures.push_back({ { "Name", name } });
+        }
+
+        root.push_back({
+            { "InterfaceUuid", uuid.substr(1, 36) },
+            { "FileName", "C:\\Windows\\System32\\svc" + std::to_string(index % 97) + ".dll" },
+            { "ServiceDisplayName", "Synthetic Service " + std::to_string(index % 97) },
+            { "ServiceName", "SynthSvc" + std::to_string(index % 97) },
+            { "Procedures", procedures }
+        });
+    }
+    return root.dump();
+}
+
+void WorkloadGenerator::writeRpcServersFile(const std::string& filePath, size_t first, size_t count, uint64_t variant) const
+{
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+    file << rpcServersJson(first, count, variant);
+}
+
+std::vector<SyntheticCall> WorkloadGenerator::calls(size_t count, uint64_t stream) const
+{
+    SplitMix64 rng(m_options.Seed + 0x632be59bd9b4e019ULL * (stream + 1));
+    ZipfDistribution interfaceRank(m_interfaces.size(), m_options.InterfaceSkew);
+    ZipfDistribution processRank(m_options.ProcessCount, m_options.ProcessSkew);
+    ZipfDistribution endpointRank(m_options.EndpointCount, m_options.EndpointSkew);
+
+    // one opnum distribution per distinct procedure count keeps setup cheap
+    std::vector<ZipfDistribution> opnumRanks;
+    opnumRanks.reserve(m_options.MaxProcedures);
+    for (size_t procedures = 1; procedures <= m_options.MaxProcedures; procedures++)
+    {
+        opnumRanks.emplace_back(procedures, m_options.OpnumSkew);
+    }
+
+    std::vector<SyntheticCall> result;
+    result.reserve(count);
+    uint64_t timestamp = 133500000000000000ULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t index = interfaceRank(rng);
+        SyntheticCall call;
+        call.InterfaceUuid = m_interfaces[index];
+        call.ProcNum = static_cast<uint32_t>(opnumRanks[m_procedureCounts[index] - 1](rng));
+        call.ProcessId = static_cast<uint32_t>(4 * (1 + (index * 31 + processRank(rng)) % m_options.ProcessCount));
+        timestamp += 1 + rng.below(2000);
+        call.Timestamp = timestamp;
+        // every interface has its own popular endpoints, so call streams repeat like real client traffic does
+        call.Endpoint = "LRPC-" + std::to_string((index * 7919 + endpointRank(rng)) % m_options.EndpointCount);
+        result.push_back(std::move(call));
+    }
+    return result;
+}
+
+static void appendUInt32(std::vector<uint8_t>& payload, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        payload.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static void appendUtf16(std::vector<uint8_t>& payload, const std::string& text)
+{
+    for (char c : text)
+    {
+        payload.push_back(static_cast<uint8_t>(c));
+        payload.push_back(0);
+    }
+    payload.push_back(0);
+    payload.push_back(0);
+}
+
+std::vector<uint8_t> WorkloadGenerator::encodePayload(const SyntheticCall& call, uint8_t version)
+{
+    std::vector<uint8_t> payload;
+    payload.reserve(64 + 2 * call.Endpoint.size());
+
+    // GUID in its in-memory layout: Data1, Data2 and Data3 little endian, Data4 as bytes
+    appendUInt32(payload, static_cast<uint32_t>(call.InterfaceUuid.High >> 32));
+    payload.push_back(static_cast<uint8_t>(call.InterfaceUuid.High >> 16));
+    payload.push_back(static_cast<uint8_t>(call.InterfaceUuid.High >> 24));
+    payload.push_back(static_cast<uint8_t>(call.InterfaceUuid.High));
+    payload.push_back(static_cast<uint8_t>(call.InterfaceUuid.High >> 8));
+    for (int i = 7; i >= 0; i--)
+    {
+        payload.push_back(static_cast<uint8_t>(call.InterfaceUuid.Low >> (8 * i)));
+    }
+
+    appendUInt32(payload, call.ProcNum);
+    appendUInt32(payload, 3);
+    appendUtf16(payload, "localhost");
+    appendUtf16(payload, call.Endpoint);
+    if (version >= 1)
+    {
+        // Options, AuthenticationLevel (packet privacy), AuthenticationService (WinNT), ImpersonationLevel (impersonate)
+        appendUInt32(payload, 0);
+        appendUInt32(payload, 6);
+        appendUInt32(payload, 10);
+        appendUInt32(payload, 3);
+    }
+    return payload;
+}
+
+size_t WorkloadGenerator::createDirectoryTree(const std::string& root, size_t directories, size_t filesPerDirectory, uint64_t stream) const
+{
+    static const char* const extensions[] = { ".json", ".xml", ".dll", ".exe", ".txt", ".log" };
+
+    SplitMix64 rng(m_options.Seed + 0x9e3779b97f4a7c15ULL * (stream + 7));
+    std::vector<std::filesystem::path> created = { std::filesystem::path(root) };
+    std::filesystem::create_directories(root);
+
+    size_t matching = 0;
+    for (size_t d = 0; d < directories; d++)
+    {
+        // attach each directory to a random earlier one so the tree gets both depth and fan-out
+        const std::filesystem::path parent = created[rng.below(created.size())];
+        const std::filesystem::path dir = parent / ("dir" + std::to_string(d));
+        std::filesystem::create_directories(dir);
+        created.push_back(dir);
+
+        for (size_t f = 0; f < filesPerDirectory; f++)
+        {
+            const size_t extension = rng.below(sizeof(extensions) / sizeof(extensions[0]));
+            std::ofstream(dir / ("file" + std::to_string(f) + extensions[extension]));
+            if (extension < 2)
+            {
+                matching++;
+            }
+        }
+    }
+    return matching;
+}
@@ -0,0 +1,146 @@
+#ifndef WORKLOADGENERATOR_H
+#define WORKLOADGENERATOR_H
+
+#include "../include/RpcUuid.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// @brief SplitMix64 class to generate reproducible random numbers on every platform \class SplitMix64
+/// @note The standard distributions are implementation defined, so all sampling is done by hand
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next();
+
+    /*!
+     * @brief Get a uniform number in [0, 1)
+     * @return double The number
+     */
+    double nextDouble();
+
+    /*!
+     * @brief Get a uniform number in [0, bound)
+     * @param bound The exclusive upper bound
+     * @return uint64_t The number
+     */
+    uint64_t below(uint64_t bound);
+
+private:
+    uint64_t state;
+};
+
+/// @brief ZipfDistribution class to sample ranks with probability proportional to 1 / rank^skew \class ZipfDistribution
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(size_t count, double skew);
+
+    /*!
+     * @brief Sample a rank
+     * @param rng The random number generator
+     * @return size_t The zero based rank, 0 is the most frequent
+     */
+    size_t operator()(SplitMix64& rng) const;
+
+private:
+    std::vector<double> cdf;
+};
+
+/// @brief WorkloadOptions struct to describe a synthetic RPC workload \struct WorkloadOptions
+struct WorkloadOptions
+{
+    uint64_t Seed = 42;
+    size_t InterfaceCount = 2000;
+    size_t MaxProcedures = 32;
+    double InterfaceSkew = 1.1;
+    double OpnumSkew = 1.0;
+    size_t ProcessCount = 256;
+    double ProcessSkew = 1.5;
+    size_t EndpointCount = 4096;
+    double EndpointSkew = 1.5;
+};
+
+/// @brief SyntheticCall struct to store one generated RPC call \struct SyntheticCall
+struct SyntheticCall
+{
+    RpcUuid InterfaceUuid;
+    uint32_t ProcNum = 0;
+    uint32_t ProcessId = 0;
+    uint64_t Timestamp = 0;
+    std::string Endpoint;
+};
+
+/// @brief WorkloadGenerator class to generate deterministic RPC server databases, event streams and directory trees \class WorkloadGenerator
+class WorkloadGenerator
+{
+public:
+    explicit WorkloadGenerator(const WorkloadOptions& options);
+
+    /*!
+     * @brief Get the generated interfaces, index 0 is the hottest one
+     * @return const std::vector<RpcUuid>& The interfaces
+     */
+    const std::vector<RpcUuid>& interfaces() const;
+
+    /*!
+     * @brief Get the number of procedures of an interface
+     * @param interfaceIndex The interface index
+     * @return size_t The procedure count
+     */
+    size_t procedureCount(size_t interfaceIndex) const;
+
+    /*!
+     * @brief Generate an rpc_servers.json document
+     * @param first The first interface index, wraps around
+     * @param count The number of interfaces
+     * @param variant 0 for the canonical names, other values rename some procedures and add some, like a different OS build would
+     * @return std::string The JSON document
+     */
+    std::string rpcServersJson(size_t first, size_t count, uint64_t variant) const;
+
+    /*!
+     * @brief Write an rpc_servers.json file
+     * @param filePath The file path
+     * @param first The first interface index, wraps around
+     * @param count The number of interfaces
+     * @param variant See rpcServersJson
+     */
+    void writeRpcServersFile(const std::string& filePath, size_t first, size_t count, uint64_t variant) const;
+
+    /*!
+     * @brief Generate a call stream with Zipfian interface and opnum popularity
+     * @param count The number of calls
+     * @param stream The stream number, different streams are independent
+     * @return std::vector<SyntheticCall> The calls, in timestamp order
+     */
+    std::vector<SyntheticCall> calls(size_t count, uint64_t stream) const;
+
+    /*!
+     * @brief Encode a call as the user data of an RPC call event
+     * @param call The call
+     * @param version The event version, 1 and above append the security fields
+     * @return std::vector<uint8_t> The payload
+     */
+    static std::vector<uint8_t> encodePayload(const SyntheticCall& call, uint8_t version = 1);
+
+    /*!
+     * @brief Create a directory tree with RPC server dumps and unrelated files
+     * @param root The root directory, created if missing
+     * @param directories The number of directories
+     * @param filesPerDirectory The number of files per directory
+     * @param stream The stream number
+     * @return size_t The number of files with a .json or .xml extension
+     */
+    size_t createDirectoryTree(const std::string& root, size_t directories, size_t filesPerDirectory, uint64_t stream) const;
+
+private:
+    WorkloadOptions m_options;
+    std::vector<RpcUuid> m_interfaces;
+    std::vector<uint32_t> m_procedureCounts;
+};
+
+#endif // WORKLOADGENERATOR_H
@@ -0,0 +1,100 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+/// @brief BoundedQueue class to hand items from a producer thread to a consumer thread with a fixed capacity \class BoundedQueue
+/// @note push never blocks, a full queue rejects the item so the producer can account for it instead of stalling
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity), depth(0) {}
+
+    /*!
+     * @brief Add an item
+     * @param item The item
+     * @param overCapacity Queue the item even if the queue is full, for rare items that must not be dropped
+     * @return bool True if the item was queued, false if the queue is full or closed
+     */
+    bool push(T item, bool overCapacity = false)
+    {
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (closed || (items.size() >= capacity && !overCapacity))
+            {
+                return false;
+            }
+            wasEmpty = items.empty();
+            items.push_back(std::move(item));
+            depth.store(items.size(), std::memory_order_relaxed);
+        }
+
+        if (wasEmpty)
+        {
+            available.notify_one();
+        }
+        return true;
+    }
+
+    /*!
+     * @brief Take all queued items, waiting until there is at least one or the timeout expires
+     * @param batch The items, replaced, empty if the timeout expired
+     * @param timeout The longest time to wait
+     * @return bool True unless the queue was closed and is empty
+     */
+    bool popAll(std::vector<T>& batch, std::chrono::milliseconds timeout)
+    {
+        batch.clear();
+        std::unique_lock<std::mutex> guard(lock);
+        available.wait_for(guard, timeout, [this]() { return closed || !items.empty(); });
+        if (items.empty())
+        {
+            return !closed;
+        }
+
+        batch.assign(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+        items.clear();
+        depth.store(0, std::memory_order_relaxed);
+        return true;
+    }
+
+    /*!
+     * @brief Reject further items and wake the consumer, items already queued can still be taken
+     */
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        available.notify_all();
+    }
+
+    /*!
+     * @brief Get the number of queued items without locking
+     * @return size_t The queue depth
+     */
+    size_t size() const
+    {
+        return depth.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t capacity;
+    std::atomic<size_t> depth;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex lock;
+    std::condition_variable available;
+};
+
+#endif // BOUNDEDQUEUE_H
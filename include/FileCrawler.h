@@ -1,9 +1,12 @@
 #ifndef FILE_CRAWLER_H
 #define FILE_CRAWLER_H
 
+#include <functional>
 #include <string>
 #include <vector>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 /// @brief FileCrawler class to search for files with specific extensions \class FileCrawler
 class FileCrawler
@@ -18,6 +21,14 @@ public:
      * */
     std::vector<std::string> findFiles(const std::vector<std::string>& extensions);
 
+    /*!
+     * @brief Find files with specific extensions, reporting each one as soon as it is found
+     * @param extensions The file extensions to search for
+     * @param onFound Called with the path of every file found, on the calling thread
+     * */
+    void findFiles(const std::vector<std::string>& extensions, const std::function<void(const std::string&)>& onFound);
+
+#ifdef _WIN32
     /*!
      * @brief Check if a file is related to RPC 
      * @param filePath The file path
@@ -31,6 +42,7 @@ public:
      * @return bool True if the executable service path matches the file path, false otherwise
      */
     bool checkExecutableServicePath(const std::string& filePath);
+#endif
 
     /*!
      * @brief Check if a string ends with a specific suffix
@@ -40,12 +52,14 @@ public:
      */
     bool endsWith(const std::string& str, const std::string& suffix);
 
+#ifdef _WIN32
     /*!
      * @brief Get the error message for a specific error code
      * @param errorCode The error code
      * @return std::string The error message
      */
     std::string getErrorMessage(DWORD errorCode);
+#endif
 
 private:
     std::string m_rootDir;
@@ -54,9 +68,9 @@ private:
      * @brief Search a directory for files with specific extensions
      * @param dir The directory to search
      * @param extensions The file extensions to search for
-     * @param foundFiles The list of files found
+     * @param onFound Called with the path of every file found
      * */
-    void searchDirectory(const std::string& dir, const std::vector<std::string>& extensions, std::vector<std::string>& foundFiles);
+    void searchDirectory(const std::string& dir, const std::vector<std::string>& extensions, const std::function<void(const std::string&)>& onFound);
 };
 
 #endif // FILE_CRAWLER_H
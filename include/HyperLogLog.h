@@ -0,0 +1,55 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <cstdint>
+#include <vector>
+
+/// @brief HyperLogLog class to estimate the number of distinct items in fixed memory \class HyperLogLog
+/// @note With precision p the sketch uses 2^p bytes and has a relative standard error of about 1.04 / sqrt(2^p)
+class HyperLogLog
+{
+public:
+    /*!
+     * @brief Construct the sketch
+     * @param precision The number of index bits, clamped to 4..16
+     */
+    explicit HyperLogLog(int precision = 10);
+
+    /*!
+     * @brief Add an item by its 64 bit hash
+     * @param hash The hash, it must be well mixed
+     */
+    void add(uint64_t hash);
+
+    /*!
+     * @brief Estimate the number of distinct items added
+     * @return double The estimate
+     */
+    double estimate() const;
+
+    /*!
+     * @brief Merge another sketch of the same precision into this one
+     * @param other The other sketch
+     * @return bool True if merged, false if the precisions differ
+     */
+    bool merge(const HyperLogLog& other);
+
+    /*!
+     * @brief Get the precision of the sketch
+     * @return int The precision
+     */
+    int precision() const;
+
+    /*!
+     * @brief Mix a 64 bit value into a well distributed hash
+     * @param value The value
+     * @return uint64_t The hash
+     */
+    static uint64_t mix(uint64_t value);
+
+private:
+    int m_precision;
+    std::vector<uint8_t> registers;
+};
+
+#endif // HYPERLOGLOG_H
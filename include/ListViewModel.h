@@ -0,0 +1,110 @@
+#ifndef LISTVIEWMODEL_H
+#define LISTVIEWMODEL_H
+
+#include "../include/SnapshotBuffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/// @brief ListViewModel class to filter and sort the rows of a RowSnapshot for a virtualized list view \class ListViewModel
+/// @note Rows appended since the last update are filtered, sorted and merged in, everything else is rebuilt only
+///       when the filter, the sort order or the snapshot generation changes
+template <typename Row>
+class ListViewModel
+{
+public:
+    using Predicate = std::function<bool(const Row&)>;
+    using Compare = std::function<bool(const Row&, const Row&)>;
+
+    /*!
+     * @brief Set the filter, rows it rejects are hidden
+     * @param predicate The filter, null to show all rows
+     */
+    void setFilter(Predicate predicate)
+    {
+        filter = std::move(predicate);
+        dirty = true;
+    }
+
+    /*!
+     * @brief Set the sort order
+     * @param compare The comparison, null to keep the snapshot order
+     */
+    void setSort(Compare compare)
+    {
+        sort = std::move(compare);
+        dirty = true;
+    }
+
+    /*!
+     * @brief Bring the visible rows up to date with a snapshot
+     * @param rows The snapshot
+     * @return bool True if the visible rows changed, false otherwise
+     */
+    bool update(const RowSnapshot<Row>& rows)
+    {
+        const bool sameRows = rows.generation() == rowGeneration;
+        if (!dirty && sameRows && rows.size() == processedRows)
+        {
+            return false;
+        }
+
+        const bool appendOnly = !dirty && sameRows && rows.size() > processedRows;
+        if (!appendOnly)
+        {
+            visible.clear();
+            processedRows = 0;
+        }
+
+        const size_t mergePoint = visible.size();
+        for (size_t i = processedRows; i < rows.size(); i++)
+        {
+            if (!filter || filter(rows[i]))
+            {
+                visible.push_back(i);
+            }
+        }
+
+        if (sort)
+        {
+            auto less = [&](size_t a, size_t b) { return sort(rows[a], rows[b]); };
+            std::stable_sort(visible.begin() + mergePoint, visible.end(), less);
+            std::inplace_merge(visible.begin(), visible.begin() + mergePoint, visible.end(), less);
+        }
+
+        rowGeneration = rows.generation();
+        processedRows = rows.size();
+        dirty = false;
+        return true;
+    }
+
+    /*!
+     * @brief Get the number of visible rows
+     * @return size_t The visible row count
+     */
+    size_t size() const
+    {
+        return visible.size();
+    }
+
+    /*!
+     * @brief Map a visible position to its row index in the snapshot
+     * @param position The visible position
+     * @return size_t The row index
+     */
+    size_t operator[](size_t position) const
+    {
+        return visible[position];
+    }
+
+private:
+    Predicate filter;
+    Compare sort;
+    std::vector<size_t> visible;
+    size_t processedRows = 0;
+    uint64_t rowGeneration = 0;
+    bool dirty = true;
+};
+
+#endif // LISTVIEWMODEL_H
@@ -0,0 +1,156 @@
+#ifndef PROCESSATTRIBUTIONCACHE_H
+#define PROCESSATTRIBUTIONCACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief ProcessAttribution struct to store the image and services of a process \struct ProcessAttribution
+struct ProcessAttribution
+{
+    uint32_t ProcessId = 0;
+    uint64_t StartTime = 0;
+    std::string ImagePath;
+    std::string ServiceName;
+    std::string ServiceDisplayName;
+    /// @brief Set by a provider that could not look everything up yet, the cache keeps it only as long as an unknown process
+    bool Provisional = false;
+};
+
+/// @brief ProcessInfoProvider class to query process information from the operating system \class ProcessInfoProvider
+class ProcessInfoProvider
+{
+public:
+    virtual ~ProcessInfoProvider() = default;
+
+    /*!
+     * @brief Query the attribution of a running process, calls are serialized by the cache
+     * @param processId The process ID
+     * @param attribution The attribution, StartTime must use the same clock as the event timestamps
+     * @return bool True if the process was found, false otherwise
+     */
+    virtual bool query(uint32_t processId, ProcessAttribution& attribution) = 0;
+};
+
+/// @brief ProcessAttributionCache class to map process IDs to their attribution \class ProcessAttributionCache
+/// @note Lookups of cached processes are lock free. Misses query the provider outside the writer lock and publish the
+///       result under it, so a slow query never blocks process start and exit events. Entries are keyed by
+///       (pid, start time) and kept current by those events, unknown processes are only remembered for a short time.
+class ProcessAttributionCache
+{
+public:
+    /*!
+     * @brief Construct the cache
+     * @param provider The provider used to fill missing entries
+     * @param bucketCount The number of hash buckets, rounded up to a power of two
+     * @param negativeLifetime How long a process the provider did not find is remembered as unknown
+     */
+    ProcessAttributionCache(std::unique_ptr<ProcessInfoProvider> provider, size_t bucketCount = 4096,
+        std::chrono::steady_clock::duration negativeLifetime = std::chrono::seconds(1));
+    ~ProcessAttributionCache();
+
+    ProcessAttributionCache(const ProcessAttributionCache&) = delete;
+    ProcessAttributionCache& operator=(const ProcessAttributionCache&) = delete;
+
+    /*!
+     * @brief Look up the attribution of a process, querying the provider if it is not cached
+     * @param processId The process ID
+     * @param timestamp The event timestamp, 0 to skip the check against the process start time
+     * @return std::shared_ptr<const ProcessAttribution> The attribution, empty apart from the PID if the process is
+     *         unknown, null if it started after the timestamp, i.e. the PID was reused since the event
+     */
+    std::shared_ptr<const ProcessAttribution> lookup(uint32_t processId, uint64_t timestamp = 0);
+
+    /*!
+     * @brief Handle a process start event, drops the entry of an earlier process with the same PID
+     * @param processId The process ID
+     * @param startTime The start time
+     */
+    void onProcessStart(uint32_t processId, uint64_t startTime);
+
+    /*!
+     * @brief Handle a process exit event
+     * @param processId The process ID
+     */
+    void onProcessExit(uint32_t processId);
+
+    /*!
+     * @brief Get the number of cached processes
+     * @return size_t The process count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Get the number of lookups served from the cache
+     * @return uint64_t The hit count
+     */
+    uint64_t hits() const;
+
+    /*!
+     * @brief Get the number of lookups that queried the provider
+     * @return uint64_t The miss count
+     */
+    uint64_t misses() const;
+
+private:
+    struct Node
+    {
+        uint32_t processId;
+        std::shared_ptr<const ProcessAttribution> attribution;
+        std::chrono::steady_clock::time_point expiresAt;
+        const Node* next;
+    };
+
+    std::unique_ptr<ProcessInfoProvider> provider;
+    std::chrono::steady_clock::duration m_negativeLifetime;
+    std::vector<std::atomic<const Node*>> buckets;
+    size_t bucketMask;
+    std::atomic<uint32_t> activeReaders;
+    std::atomic<size_t> entryCount;
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+    std::mutex writerMutex;
+    std::mutex providerMutex;
+    uint64_t invalidationCount;
+    std::vector<const Node*> retiredNodes;
+
+    /*!
+     * @brief Find the cached attribution of a process without taking any lock
+     * @param processId The process ID
+     * @param now The current time, expired entries are not returned
+     * @return std::shared_ptr<const ProcessAttribution> The attribution, null if not cached
+     */
+    std::shared_ptr<const ProcessAttribution> find(uint32_t processId, std::chrono::steady_clock::time_point now);
+
+    /*!
+     * @brief Query the provider for a process that is not cached and publish the result
+     * @param processId The process ID
+     * @return std::shared_ptr<const ProcessAttribution> The attribution, empty apart from the PID if the process is unknown
+     */
+    std::shared_ptr<const ProcessAttribution> fill(uint32_t processId);
+
+    /*!
+     * @brief Replace the bucket chain of a process without the process, the caller holds the writer lock
+     * @param processId The process ID
+     * @param olderThan Only remove the entry if it started before this time
+     */
+    void removeLocked(uint32_t processId, uint64_t olderThan);
+
+    /*!
+     * @brief Free retired nodes once no reader can still see them, the caller holds the writer lock
+     */
+    void reclaimLocked();
+
+    /*!
+     * @brief Get the bucket of a process
+     * @param processId The process ID
+     * @return std::atomic<const Node*>& The bucket
+     */
+    std::atomic<const Node*>& bucketFor(uint32_t processId);
+};
+
+#endif // PROCESSATTRIBUTIONCACHE_H
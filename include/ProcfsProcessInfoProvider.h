@@ -0,0 +1,29 @@
+#ifndef PROCFSPROCESSINFOPROVIDER_H
+#define PROCFSPROCESSINFOPROVIDER_H
+
+#include "../include/ProcessAttributionCache.h"
+#include <string>
+
+/// @brief ProcfsProcessInfoProvider class to query process information from /proc, used to run the cache on Linux \class ProcfsProcessInfoProvider
+class ProcfsProcessInfoProvider : public ProcessInfoProvider
+{
+public:
+    /*!
+     * @brief Construct the provider
+     * @param procRoot The mount point of the proc file system
+     */
+    ProcfsProcessInfoProvider(const std::string& procRoot = "/proc");
+
+    /*!
+     * @brief Query the image path and start time of a process, the systemd unit stands in for the service
+     * @param processId The process ID
+     * @param attribution The attribution, StartTime is in clock ticks since boot
+     * @return bool True if the process was found, false otherwise
+     */
+    bool query(uint32_t processId, ProcessAttribution& attribution) override;
+
+private:
+    std::string m_procRoot;
+};
+
+#endif // PROCFSPROCESSINFOPROVIDER_H
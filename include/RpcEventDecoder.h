@@ -0,0 +1,103 @@
+#ifndef RPCEVENTDECODER_H
+#define RPCEVENTDECODER_H
+
+#include "../include/RpcUuid.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+
+/// @brief RpcCallPayload struct to store the decoded payload of an RPC call event \struct RpcCallPayload
+struct RpcCallPayload
+{
+    RpcUuid InterfaceUuid;
+    uint32_t ProcNum = 0;
+    uint32_t Protocol = 0;
+    std::string NetworkAddress;
+    std::string Endpoint;
+    uint32_t Options = 0;
+    uint32_t AuthenticationLevel = 0;
+    uint32_t AuthenticationService = 0;
+    uint32_t ImpersonationLevel = 0;
+};
+
+/// @brief RpcCallRecord struct to store an RPC call event on its way from the ETW callback to the processing thread \struct RpcCallRecord
+struct RpcCallRecord
+{
+    uint32_t ProcessId = 0;
+    uint32_t ThreadId = 0;
+    uint64_t Timestamp = 0;
+    double Weight = 1.0;
+    RpcCallPayload Payload;
+};
+
+/// @brief RpcProcessChange struct to store a process start or exit on its way from the ETW callback to the processing thread \struct RpcProcessChange
+struct RpcProcessChange
+{
+    uint32_t ProcessId = 0;
+    uint64_t Timestamp = 0;
+    bool Started = false;
+};
+
+/// @brief RpcIngestRecord type of the items queued for the processing thread, calls and process changes share one queue to keep their order
+using RpcIngestRecord = std::variant<RpcCallRecord, RpcProcessChange>;
+
+/// @brief RpcPayloadDecoder type of the decoders generated for each (event id, version) in RpcEventSchema.h
+using RpcPayloadDecoder = bool (*)(const uint8_t* data, size_t length, RpcCallPayload& payload);
+
+/*!
+ * @brief Decode the payload of an RPC call event with the layout declared for its event id and version
+ * @param eventId The event id
+ * @param version The event version
+ * @param data The event user data
+ * @param length The user data length in bytes
+ * @param payload The decoded payload
+ * @return bool True if the event has a declared layout and the payload is long enough to hold its fixed fields, false otherwise
+ */
+bool decodeRpcEvent(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallPayload& payload);
+
+/*!
+ * @brief Read only the interface UUID of an RPC call event, so sampling can drop it before its strings are converted
+ * @param eventId The event id
+ * @param version The event version
+ * @param data The event user data
+ * @param length The user data length in bytes
+ * @param interfaceUuid The interface UUID
+ * @return bool True if decodeRpcEvent would accept the event, false otherwise
+ */
+bool peekRpcInterface(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcUuid& interfaceUuid);
+
+/*!
+ * @brief Decode the payload of an RPC client call event
+ * @param data The event user data, InterfaceUuid, ProcNum and Protocol followed by NetworkAddress and Endpoint as UTF-16
+ *             strings, optionally followed by Options, AuthenticationLevel, AuthenticationService and ImpersonationLevel
+ * @param length The user data length in bytes
+ * @param payload The decoded payload
+ * @return bool True if the payload is long enough to hold the fixed fields, false otherwise
+ */
+bool decodeRpcCallPayload(const uint8_t* data, size_t length, RpcCallPayload& payload);
+
+/*!
+ * @brief Read a little endian 32 bit unsigned integer
+ * @param data The integer bytes, 4 bytes
+ * @return uint32_t The integer
+ */
+uint32_t readUInt32(const uint8_t* data);
+
+/*!
+ * @brief Read a GUID in its little endian in-memory layout
+ * @param data The GUID bytes, 16 bytes
+ * @return RpcUuid The UUID
+ */
+RpcUuid readGuid(const uint8_t* data);
+
+/*!
+ * @brief Read a null terminated little endian UTF-16 string and convert it to UTF-8
+ * @param data The string bytes
+ * @param length The number of bytes available
+ * @param bytesRead The number of bytes consumed, including the terminator if present
+ * @return std::string The UTF-8 string
+ */
+std::string readUtf16String(const uint8_t* data, size_t length, size_t& bytesRead);
+
+#endif // RPCEVENTDECODER_H
@@ -0,0 +1,27 @@
+#ifndef RPCEVENTINGEST_H
+#define RPCEVENTINGEST_H
+
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcLoadShedder.h"
+#include "../include/BoundedQueue.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * @brief Sample, decode and queue one RPC call event, the path of the ETW callback, shared with the replay benchmarks
+ * @param shedder The load shedder, only used by the producer thread
+ * @param queue The ingest queue of the processing thread
+ * @param eventId The event id
+ * @param version The event version
+ * @param data The event user data
+ * @param length The user data length in bytes
+ * @param record The call with its ProcessId, ThreadId and Timestamp set, its payload and weight are filled in here
+ * @param now The current time
+ * @return bool True if the call was queued, false if it has no declared layout, was sampled out or the queue was full
+ * @note Only the interface UUID is read before admission, a sampled out event never pays for converting its strings
+ */
+bool ingestRpcEvent(RpcLoadShedder& shedder, BoundedQueue<RpcIngestRecord>& queue, uint16_t eventId, uint8_t version,
+    const uint8_t* data, size_t length, RpcCallRecord record, std::chrono::steady_clock::time_point now);
+
+#endif // RPCEVENTINGEST_H
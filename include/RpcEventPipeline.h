@@ -0,0 +1,117 @@
+#ifndef RPCEVENTPIPELINE_H
+#define RPCEVENTPIPELINE_H
+
+#include "../include/RpcServersDatabase.h"
+#include "../include/ProcessAttributionCache.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventStore.h"
+#include "../include/RpcTrafficSketch.h"
+#include "../include/SnapshotBuffer.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+/// @brief RpcEventPipeline class to resolve, attribute, summarize and store decoded RPC calls \class RpcEventPipeline
+/// @note Platform neutral, RpcMonitor feeds it from ETW and the benchmarks from synthetic calls. process() and
+///       publishEvents() are called by one processing thread, the other methods may be called from any thread.
+class RpcEventPipeline
+{
+public:
+    /*!
+     * @brief Construct the pipeline
+     * @param database The RPC servers database calls are resolved against, reloads are picked up between calls
+     * @param provider The provider the process attribution cache is filled from
+     */
+    RpcEventPipeline(std::shared_ptr<RpcServersDatabase> database, std::unique_ptr<ProcessInfoProvider> provider);
+
+    RpcEventPipeline(const RpcEventPipeline&) = delete;
+    RpcEventPipeline& operator=(const RpcEventPipeline&) = delete;
+
+    /*!
+     * @brief Resolve, attribute, summarize and store one call
+     * @param record The call
+     */
+    void process(const RpcCallRecord& record);
+
+    /*!
+     * @brief Apply a process start or exit to the process attribution cache, calls processed after it see the change
+     * @param change The process change
+     */
+    void process(const RpcProcessChange& change);
+
+    /*!
+     * @brief Process a queued call or process change
+     * @param record The call or process change
+     */
+    void process(const RpcIngestRecord& record);
+
+    /*!
+     * @brief Publish a snapshot of the stored events if new ones arrived and the last one is old enough
+     * @param force Publish pending events even if the last snapshot is recent
+     */
+    void publishEvents(bool force = false);
+
+    /*!
+     * @brief Get a snapshot of the stored events, it shares storage with the pipeline instead of copying the events
+     * @return RpcEventSnapshot The events
+     */
+    RpcEventSnapshot getEvents() const;
+
+    /*!
+     * @brief Get the number of stored events
+     * @return size_t The event count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Get the RPC servers database
+     * @return RpcServersDatabase& The RPC servers database
+     */
+    RpcServersDatabase& getDatabase();
+
+    /*!
+     * @brief Get the cache attributing process IDs to images and services
+     * @return ProcessAttributionCache& The process attribution cache
+     */
+    ProcessAttributionCache& getProcessCache();
+
+    /*!
+     * @brief Get the cache attributing process IDs to images and services
+     * @return const ProcessAttributionCache& The process attribution cache
+     */
+    const ProcessAttributionCache& getProcessCache() const;
+
+    /*!
+     * @brief Get a copy of the heavy hitter and endpoint cardinality sketch of the processed calls
+     * @return RpcTrafficSketch The traffic sketch
+     */
+    RpcTrafficSketch getTrafficSketch() const;
+
+    /*!
+     * @brief Get the event snapshots published by publishEvents, a single reader thread may call update() on it
+     * @return SnapshotBuffer<RpcEventSnapshot>& The event snapshots
+     */
+    SnapshotBuffer<RpcEventSnapshot>& getEventSnapshots();
+
+private:
+    std::shared_ptr<RpcServersDatabase> database;
+    RpcServersDatabase::Reader databaseReader;
+    ProcessAttributionCache processCache;
+    RpcEventStore collectedEvents;
+    RpcTrafficSketch trafficSketch;
+    SnapshotBuffer<RpcEventSnapshot> eventSnapshots;
+    std::chrono::steady_clock::time_point lastSnapshotTime;
+    bool snapshotPending = false;
+    mutable std::mutex lock;
+
+    /*!
+     * @brief Build the RPC event of a call, resolving its interface
+     * @param record The call
+     * @param config The config to resolve the interface in
+     * @return RpcEvent The RPC event, the store fills in the endpoint and process handles
+     */
+    RpcEvent parseRpcEvent(const RpcCallRecord& record, const RpcServersConfig& config);
+};
+
+#endif // RPCEVENTPIPELINE_H
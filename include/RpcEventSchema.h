@@ -0,0 +1,287 @@
+#ifndef RPCEVENTSCHEMA_H
+#define RPCEVENTSCHEMA_H
+
+#include "../include/RpcEventDecoder.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+/// @brief The offset a field extractor uses once a variable length field made offsets depend on the payload
+constexpr size_t RpcDynamicOffset = (std::numeric_limits<size_t>::max)();
+
+template <typename Class, typename Type>
+Type rpcMemberType(Type Class::*);
+
+/// @brief RpcPayloadField struct to describe one payload field by the RpcCallPayload member it is stored in \struct RpcPayloadField
+/// @note The member type selects the wire format: RpcUuid is a 16 byte GUID, uint32_t is little endian and std::string is a
+///       null terminated UTF-16 string
+template <auto MemberPointer>
+struct RpcPayloadField
+{
+    static constexpr auto Member = MemberPointer;
+    using Type = decltype(rpcMemberType(Member));
+    static_assert(std::is_same_v<Type, RpcUuid> || std::is_same_v<Type, uint32_t> || std::is_same_v<Type, std::string>,
+        "RpcPayloadField only supports RpcUuid, uint32_t and std::string members");
+
+    /// @brief The wire size in bytes, 0 for variable length fields
+    static constexpr size_t Size = std::is_same_v<Type, RpcUuid> ? 16 : std::is_same_v<Type, uint32_t> ? 4 : 0;
+
+    static void read(const uint8_t* data, RpcCallPayload& payload)
+    {
+        if constexpr (std::is_same_v<Type, RpcUuid>)
+        {
+            payload.*Member = readGuid(data);
+        }
+        else
+        {
+            payload.*Member = readUInt32(data);
+        }
+    }
+};
+
+/// @brief RpcFieldExtractor struct to generate the straight-line extraction of a field list \struct RpcFieldExtractor
+/// @note While Offset is a constant the fields are read at fixed offsets without bounds checks, the schema checked the
+///       length of the fixed prefix once. After the first string every field is bounds checked and a payload that
+///       stops early leaves the remaining fields at their defaults.
+template <size_t Offset, typename... Fields>
+struct RpcFieldExtractor
+{
+    static void extract(const uint8_t*, size_t, size_t, RpcCallPayload&) {}
+};
+
+template <size_t Offset, typename Field, typename... Rest>
+struct RpcFieldExtractor<Offset, Field, Rest...>
+{
+    static void extract(const uint8_t* data, size_t length, size_t offset, RpcCallPayload& payload)
+    {
+        if constexpr (Field::Size != 0 && Offset != RpcDynamicOffset)
+        {
+            Field::read(data + Offset, payload);
+            RpcFieldExtractor<Offset + Field::Size, Rest...>::extract(data, length, Offset + Field::Size, payload);
+        }
+        else if constexpr (Field::Size != 0)
+        {
+            if (length - offset < Field::Size)
+            {
+                return;
+            }
+            Field::read(data + offset, payload);
+            RpcFieldExtractor<RpcDynamicOffset, Rest...>::extract(data, length, offset + Field::Size, payload);
+        }
+        else
+        {
+            size_t bytesRead = 0;
+            payload.*Field::Member = readUtf16String(data + offset, length - offset, bytesRead);
+            RpcFieldExtractor<RpcDynamicOffset, Rest...>::extract(data, length, offset + bytesRead, payload);
+        }
+    }
+};
+
+/*!
+ * @brief Get the length of the fixed size fields before the first variable length one
+ * @return size_t The length in bytes
+ */
+template <typename... Fields>
+constexpr size_t rpcFixedPrefixLength()
+{
+    constexpr size_t sizes[] = { Fields::Size... };
+    size_t length = 0;
+    for (size_t size : sizes)
+    {
+        if (size == 0)
+        {
+            break;
+        }
+        length += size;
+    }
+    return length;
+}
+
+/*!
+ * @brief Get the offset of a field in the fixed size prefix
+ * @return size_t The offset in bytes, RpcDynamicOffset if the field is missing or follows a variable length field
+ */
+template <typename Target, typename... Fields>
+constexpr size_t rpcFixedFieldOffset()
+{
+    constexpr bool matches[] = { std::is_same_v<Fields, Target>... };
+    constexpr size_t sizes[] = { Fields::Size... };
+    size_t offset = 0;
+    for (size_t i = 0; i < sizeof...(Fields); i++)
+    {
+        if (sizes[i] == 0)
+        {
+            break;
+        }
+        if (matches[i])
+        {
+            return offset;
+        }
+        offset += sizes[i];
+    }
+    return RpcDynamicOffset;
+}
+
+/// @brief RpcEventLayout struct to store the generated decoder of an (event id, version) and where its interface UUID is \struct RpcEventLayout
+struct RpcEventLayout
+{
+    RpcPayloadDecoder Decode = nullptr;
+    /// @brief The shortest payload the decoder accepts
+    size_t FixedLength = 0;
+    /// @brief The offset of the interface UUID, inside the fixed prefix so it can be read without decoding the rest
+    size_t InterfaceUuidOffset = 0;
+};
+
+/// @brief RpcEventSchema struct to declare the payload layout of one (event id, version) and generate its decoder \struct RpcEventSchema
+template <uint16_t EventId, uint8_t EventVersion, typename... Fields>
+struct RpcEventSchema
+{
+    static_assert(sizeof...(Fields) > 0, "an event schema needs at least one field");
+
+    static constexpr uint16_t Id = EventId;
+    static constexpr uint8_t Version = EventVersion;
+    /// @brief The shortest payload the decoder accepts
+    static constexpr size_t FixedLength = rpcFixedPrefixLength<Fields...>();
+    static constexpr size_t InterfaceUuidOffset = rpcFixedFieldOffset<RpcPayloadField<&RpcCallPayload::InterfaceUuid>, Fields...>();
+    static_assert(InterfaceUuidOffset != RpcDynamicOffset, "the interface UUID must be in the fixed prefix, sampling reads it before decoding");
+
+    /*!
+     * @brief Decode a payload with this layout
+     * @param data The event user data
+     * @param length The user data length in bytes
+     * @param payload The decoded payload, overwritten, members the layout lacks are reset to their defaults
+     * @return bool True if the payload is long enough to hold the fixed prefix, false otherwise
+     */
+    static bool decode(const uint8_t* data, size_t length, RpcCallPayload& payload)
+    {
+        if (length < FixedLength)
+        {
+            return false;
+        }
+
+        payload = RpcCallPayload();
+        RpcFieldExtractor<0, Fields...>::extract(data, length, 0, payload);
+        return true;
+    }
+};
+
+/*!
+ * @brief Check that no (event id, version) is declared twice
+ * @return bool True if every schema has its own slot
+ */
+template <typename... Schemas>
+constexpr bool rpcSchemasAreUnique()
+{
+    constexpr uint32_t keys[] = { (static_cast<uint32_t>(Schemas::Id) << 8 | Schemas::Version)... };
+    for (size_t i = 0; i < sizeof...(Schemas); i++)
+    {
+        for (size_t j = i + 1; j < sizeof...(Schemas); j++)
+        {
+            if (keys[i] == keys[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*!
+ * @brief Build the dense layout table of a schema list
+ * @return std::array<RpcEventLayout, Size> The layouts, indexed by id * VersionCount + version
+ * @note A missing version of a declared event id uses the closest lower declared version, event versions only append
+ *       fields so that layout still reads the prefix it knows
+ */
+template <size_t Size, size_t VersionCount, typename... Schemas>
+constexpr std::array<RpcEventLayout, Size> buildRpcDecoderTable()
+{
+    // declared slots are tracked on the side, comparing function addresses is not a constant expression everywhere
+    std::array<RpcEventLayout, Size> layouts{};
+    std::array<bool, Size> declared{};
+    ((layouts[Schemas::Id * VersionCount + Schemas::Version] = RpcEventLayout{ &Schemas::decode, Schemas::FixedLength, Schemas::InterfaceUuidOffset }), ...);
+    ((declared[Schemas::Id * VersionCount + Schemas::Version] = true), ...);
+    for (size_t slot = 0; slot < Size; slot++)
+    {
+        if (slot % VersionCount != 0 && !declared[slot])
+        {
+            layouts[slot] = layouts[slot - 1];
+        }
+    }
+    return layouts;
+}
+
+/// @brief RpcEventDecoderTable class to dispatch a payload to the decoder generated for its (event id, version) \class RpcEventDecoderTable
+/// @note The table is a flat array built at compile time, a lookup is two compares and one indexed load
+template <typename... Schemas>
+class RpcEventDecoderTable
+{
+public:
+    static_assert(rpcSchemasAreUnique<Schemas...>(), "an (event id, version) is declared twice");
+
+    static constexpr uint16_t MaxEventId = (std::max)({ Schemas::Id... });
+    static constexpr size_t VersionCount = static_cast<size_t>((std::max)({ Schemas::Version... })) + 1;
+
+    /*!
+     * @brief Find the decoder of an event
+     * @param eventId The event id
+     * @param version The event version, versions above the newest declared one use the newest
+     * @return RpcPayloadDecoder The decoder, nullptr if the event id has no schema
+     */
+    static constexpr RpcPayloadDecoder find(uint16_t eventId, uint8_t version)
+    {
+        return layout(eventId, version).Decode;
+    }
+
+    /*!
+     * @brief Find the layout of an event
+     * @param eventId The event id
+     * @param version The event version, versions above the newest declared one use the newest
+     * @return RpcEventLayout The layout, its decoder is nullptr if the event id has no schema
+     */
+    static constexpr RpcEventLayout layout(uint16_t eventId, uint8_t version)
+    {
+        if (eventId > MaxEventId)
+        {
+            return RpcEventLayout();
+        }
+        const size_t clampedVersion = version < VersionCount ? version : VersionCount - 1;
+        return layouts[eventId * VersionCount + clampedVersion];
+    }
+
+private:
+    static constexpr std::array<RpcEventLayout, (MaxEventId + 1) * VersionCount> layouts =
+        buildRpcDecoderTable<(MaxEventId + 1) * VersionCount, VersionCount, Schemas...>();
+};
+
+constexpr uint16_t RpcClientCallStartEventId = 5;
+constexpr uint16_t RpcServerCallStartEventId = 7;
+
+using RpcInterfaceUuidField = RpcPayloadField<&RpcCallPayload::InterfaceUuid>;
+using RpcProcNumField = RpcPayloadField<&RpcCallPayload::ProcNum>;
+using RpcProtocolField = RpcPayloadField<&RpcCallPayload::Protocol>;
+using RpcNetworkAddressField = RpcPayloadField<&RpcCallPayload::NetworkAddress>;
+using RpcEndpointField = RpcPayloadField<&RpcCallPayload::Endpoint>;
+using RpcOptionsField = RpcPayloadField<&RpcCallPayload::Options>;
+using RpcAuthenticationLevelField = RpcPayloadField<&RpcCallPayload::AuthenticationLevel>;
+using RpcAuthenticationServiceField = RpcPayloadField<&RpcCallPayload::AuthenticationService>;
+using RpcImpersonationLevelField = RpcPayloadField<&RpcCallPayload::ImpersonationLevel>;
+
+/// @brief The payload layouts of the Microsoft-Windows-RPC call events, a new event version is one more entry here
+using RpcEventDecoders = RpcEventDecoderTable<
+    RpcEventSchema<RpcClientCallStartEventId, 0,
+        RpcInterfaceUuidField, RpcProcNumField, RpcProtocolField, RpcNetworkAddressField, RpcEndpointField>,
+    RpcEventSchema<RpcClientCallStartEventId, 1,
+        RpcInterfaceUuidField, RpcProcNumField, RpcProtocolField, RpcNetworkAddressField, RpcEndpointField,
+        RpcOptionsField, RpcAuthenticationLevelField, RpcAuthenticationServiceField, RpcImpersonationLevelField>,
+    RpcEventSchema<RpcServerCallStartEventId, 0,
+        RpcInterfaceUuidField, RpcProcNumField, RpcProtocolField, RpcNetworkAddressField, RpcEndpointField>,
+    RpcEventSchema<RpcServerCallStartEventId, 1,
+        RpcInterfaceUuidField, RpcProcNumField, RpcProtocolField, RpcNetworkAddressField, RpcEndpointField,
+        RpcOptionsField, RpcAuthenticationLevelField, RpcAuthenticationServiceField, RpcImpersonationLevelField>
+>;
+
+#endif // RPCEVENTSCHEMA_H
@@ -0,0 +1,421 @@
+#ifndef RPCEVENTSTORE_H
+#define RPCEVENTSTORE_H
+
+#include "../include/RpcUuid.h"
+#include "../include/RpcServersConfig.h"
+#include "../include/ProcessAttributionCache.h"
+#include "../include/SnapshotBuffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief RpcEvent struct to store RPC event information \struct RpcEvent
+/// @note A row only holds fixed size keys and handles, names are looked up when the row is displayed. The server
+///       record, the endpoint and the process attribution are interned by the store, the endpoint and the process
+///       attribution are read back through RpcEventSnapshot::endpoint and RpcEventSnapshot::process.
+struct RpcEvent
+{
+    uint64_t Timestamp = 0;
+    RpcUuid InterfaceUuid;
+    /// @brief The resolved interface, null if the database does not know it. RpcEventStore::append repoints it to its own copy
+    const RpcServerRecord* Server = nullptr;
+    uint32_t ProcessId = 0;
+    uint32_t ThreadId = 0;
+    /// @brief The handle of the endpoint, assigned by RpcEventStore::append
+    uint32_t EndpointId = 0;
+    /// @brief The handle of the process attribution, assigned by RpcEventStore::append
+    uint32_t ProcessInfoId = 0;
+    /// @brief The opnum, 16 bits on the wire
+    uint16_t ProcedureNum = 0;
+    uint16_t Protocol = 0;
+    /// @brief The number of calls this event stands for, above 1 when sampling dropped some
+    float Weight = 1.0f;
+
+    /*!
+     * @brief Get the name of the called procedure
+     * @return std::string_view The procedure name, empty if the interface or the opnum is unknown
+     */
+    std::string_view procedureName() const;
+
+    /*!
+     * @brief Get the file of the RPC server
+     * @return std::string_view The file name, empty if the interface is unknown
+     */
+    std::string_view fileName() const;
+};
+
+/// @brief RpcEventQuery struct to describe which captured events a query returns \struct RpcEventQuery
+struct RpcEventQuery
+{
+    /// @brief The first timestamp to return, inclusive
+    uint64_t From = 0;
+    /// @brief The last timestamp to return, inclusive
+    uint64_t To = (std::numeric_limits<uint64_t>::max)();
+    /// @brief Only return calls to this interface, answered from the segment indexes
+    std::optional<RpcUuid> InterfaceUuid;
+    /// @brief Only return calls made by this process, answered from the segment indexes
+    std::optional<uint32_t> ProcessId;
+    /// @brief Any other condition, evaluated on the events the indexes let through
+    std::function<bool(const RpcEvent&)> Predicate;
+};
+
+/// @brief PostingIndex class to map keys to the sorted rows of a segment that contain them \class PostingIndex
+template <typename Key>
+class PostingIndex
+{
+public:
+    /*!
+     * @brief Build the index
+     * @param entries The (key, row) pairs, in any order
+     */
+    void build(std::vector<std::pair<Key, uint32_t>> entries)
+    {
+        std::sort(entries.begin(), entries.end());
+
+        keys.clear();
+        starts.clear();
+        rows.clear();
+        rows.reserve(entries.size());
+        for (const auto& entry : entries)
+        {
+            if (keys.empty() || keys.back() != entry.first)
+            {
+                keys.push_back(entry.first);
+                starts.push_back(static_cast<uint32_t>(rows.size()));
+            }
+            rows.push_back(entry.second);
+        }
+        starts.push_back(static_cast<uint32_t>(rows.size()));
+    }
+
+    /*!
+     * @brief Get the rows that contain a key
+     * @param key The key
+     * @return std::pair<const uint32_t*, const uint32_t*> The rows in ascending order, an empty range if the key is absent
+     */
+    std::pair<const uint32_t*, const uint32_t*> find(const Key& key) const
+    {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if (it == keys.end() || key < *it)
+        {
+            return { nullptr, nullptr };
+        }
+
+        const size_t index = static_cast<size_t>(it - keys.begin());
+        return { rows.data() + starts[index], rows.data() + starts[index + 1] };
+    }
+
+    /*!
+     * @brief Get the number of bytes held by the index
+     * @return size_t The byte count
+     */
+    size_t bytes() const
+    {
+        return keys.capacity() * sizeof(Key) + (starts.capacity() + rows.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<Key> keys;
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> rows;
+};
+
+/// @brief RpcEventSegment struct to store the time range and indexes of consecutive captured events \struct RpcEventSegment
+struct RpcEventSegment
+{
+    size_t FirstRow = 0;
+    uint32_t RowCount = 0;
+    uint64_t MinTimestamp = 0;
+    uint64_t MaxTimestamp = 0;
+    /// @brief The largest timestamp of this and all earlier segments, it never decreases so queries can binary search it
+    uint64_t MaxTimestampSoFar = 0;
+    PostingIndex<RpcUuid> Interfaces;
+    PostingIndex<uint32_t> Processes;
+};
+
+class RpcEventRange;
+
+/// @brief RpcEventSnapshot class to query an immutable view of the captured events \class RpcEventSnapshot
+/// @note Rows and sealed segments are shared with the store and with other snapshots, taking a snapshot copies neither.
+///       Copies of a snapshot share all of it, so copying one costs a reference count.
+class RpcEventSnapshot
+{
+public:
+    /*!
+     * @brief Get the rows in capture order, for list views
+     * @return const RowSnapshot<RpcEvent>& The rows
+     */
+    const RowSnapshot<RpcEvent>& rows() const;
+
+    /*!
+     * @brief Get the number of events
+     * @return size_t The event count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Query the events, in capture order
+     * @param query The query
+     * @return RpcEventRange The matching events, the range shares this snapshot so it may outlive it
+     */
+    RpcEventRange query(RpcEventQuery query) const&;
+
+    /*!
+     * @brief Query the events of a temporary snapshot, in capture order
+     * @param query The query
+     * @return RpcEventRange The matching events, the snapshot is moved into the range
+     */
+    RpcEventRange query(RpcEventQuery query) &&;
+
+    /*!
+     * @brief Get the endpoint of an event
+     * @param event An event of this snapshot
+     * @return std::string_view The endpoint
+     */
+    std::string_view endpoint(const RpcEvent& event) const;
+
+    /*!
+     * @brief Get the attribution of the process that made a call
+     * @param event An event of this snapshot
+     * @return const ProcessAttribution* The attribution, null if the call was not attributed
+     */
+    const ProcessAttribution* process(const RpcEvent& event) const;
+
+private:
+    friend class RpcEventStore;
+    friend class RpcEventIterator;
+
+    /// @brief Contents struct to share one cut of the store between all copies of a snapshot \struct Contents
+    struct Contents
+    {
+        RowSnapshot<RpcEvent> Rows;
+        std::vector<std::shared_ptr<const RpcEventSegment>> Segments;
+        RowSnapshot<std::string_view> Endpoints;
+        RowSnapshot<std::shared_ptr<const ProcessAttribution>> Processes;
+        RowSnapshot<std::shared_ptr<const RpcServerRecord>> Servers;
+        std::shared_ptr<const RpcStringPool> Strings;
+    };
+
+    std::shared_ptr<Contents> m_contents;
+
+    /*!
+     * @brief Get the contents, empty for a snapshot that was never written
+     * @return const Contents& The contents
+     */
+    const Contents& contents() const;
+};
+
+/// @brief RpcEventQueryState struct to keep a query and the snapshot it runs on alive for its range and iterators \struct RpcEventQueryState
+struct RpcEventQueryState
+{
+    RpcEventSnapshot Snapshot;
+    RpcEventQuery Query;
+};
+
+/// @brief RpcEventIterator class to walk the events matching a query without copying them \class RpcEventIterator
+class RpcEventIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = RpcEvent;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const RpcEvent*;
+    using reference = const RpcEvent&;
+
+    /*!
+     * @brief Construct the end iterator
+     */
+    RpcEventIterator() = default;
+
+    /*!
+     * @brief Construct an iterator at the first match
+     * @param state The snapshot and the query
+     */
+    explicit RpcEventIterator(std::shared_ptr<const RpcEventQueryState> state);
+
+    reference operator*() const
+    {
+        return contents->Rows[currentRow];
+    }
+
+    pointer operator->() const
+    {
+        return &contents->Rows[currentRow];
+    }
+
+    RpcEventIterator& operator++()
+    {
+        advance();
+        return *this;
+    }
+
+    RpcEventIterator operator++(int)
+    {
+        RpcEventIterator previous = *this;
+        advance();
+        return previous;
+    }
+
+    bool operator==(const RpcEventIterator& other) const
+    {
+        return currentRow == other.currentRow;
+    }
+
+    bool operator!=(const RpcEventIterator& other) const
+    {
+        return currentRow != other.currentRow;
+    }
+
+    /*!
+     * @brief Get the row index of the current event in RpcEventSnapshot::rows()
+     * @return size_t The row index
+     */
+    size_t row() const
+    {
+        return currentRow;
+    }
+
+private:
+    static constexpr size_t EndRow = (std::numeric_limits<size_t>::max)();
+
+    std::shared_ptr<const RpcEventQueryState> state;
+    const RpcEventSnapshot::Contents* contents = nullptr;
+    const RpcEventQuery* query = nullptr;
+    size_t segmentIndex = 0;
+    const uint32_t* candidate = nullptr;
+    const uint32_t* candidateEnd = nullptr;
+    const uint32_t* filterBegin = nullptr;
+    const uint32_t* filterEnd = nullptr;
+    uint32_t scanRow = 0;
+    uint32_t scanEnd = 0;
+    bool useIndex = false;
+    bool useFilter = false;
+    size_t currentRow = EndRow;
+
+    /*!
+     * @brief Move to the next segment that can hold matches, starting at segmentIndex
+     */
+    void enterSegment();
+
+    /*!
+     * @brief Move to the next match or to the end
+     */
+    void advance();
+};
+
+/// @brief RpcEventRange class to hold a query so it can be iterated with a range based for loop \class RpcEventRange
+/// @note The range owns its snapshot, so iterating the result of a temporary like getEvents().query(q) is safe
+class RpcEventRange
+{
+public:
+    RpcEventRange(RpcEventSnapshot snapshot, RpcEventQuery query)
+        : state(std::make_shared<const RpcEventQueryState>(RpcEventQueryState{ std::move(snapshot), std::move(query) })) {}
+
+    RpcEventIterator begin() const
+    {
+        return RpcEventIterator(state);
+    }
+
+    RpcEventIterator end() const
+    {
+        return RpcEventIterator();
+    }
+
+private:
+    std::shared_ptr<const RpcEventQueryState> state;
+};
+
+/// @brief RpcEventStore class to store captured events in time segments indexed by interface and process \class RpcEventStore
+/// @note Rows live in a RowSnapshotBuilder, every SegmentRows rows the segment is sealed and its indexes are built once.
+///       A query binary searches the first segment in its time range, skips segments outside of it and walks the
+///       posting lists of the rest, so its cost follows the matches instead of the capture size.
+class RpcEventStore
+{
+public:
+    static constexpr uint32_t SegmentRows = 8192;
+
+    RpcEventStore();
+
+    /*!
+     * @brief Append an event
+     * @param event The event, its EndpointId and ProcessInfoId are assigned here
+     * @param endpoint The endpoint, stored once per distinct value
+     * @param process The attribution of the calling process, stored once per distinct attribution, may be null
+     * @param config The config event.Server points into, may be null. The record is copied into the store once per config
+     *        generation, so the config is not kept alive
+     */
+    void append(RpcEvent event, std::string_view endpoint, const std::shared_ptr<const ProcessAttribution>& process = nullptr,
+        const RpcServersConfig* config = nullptr);
+
+    /*!
+     * @brief Get the number of events
+     * @return size_t The event count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Get an event
+     * @param index The row index
+     * @return const RpcEvent& The event
+     */
+    const RpcEvent& operator[](size_t index) const;
+
+    /*!
+     * @brief Write a snapshot of the current events
+     * @param snapshot The snapshot to overwrite, typically the back buffer of a SnapshotBuffer
+     * @note Indexes the unsealed tail, so the cost is bounded by SegmentRows
+     */
+    void snapshot(RpcEventSnapshot& snapshot) const;
+
+    /*!
+     * @brief Get the number of bytes held by the rows, the segment indexes, the interned endpoints and server records
+     * @return size_t The byte count, without the process attributions shared with their owners
+     */
+    size_t bytes() const;
+
+private:
+    RowSnapshotBuilder<RpcEvent> rows;
+    RowSnapshotBuilder<std::string_view> endpoints;
+    RowSnapshotBuilder<std::shared_ptr<const ProcessAttribution>> processes;
+    RowSnapshotBuilder<std::shared_ptr<const RpcServerRecord>> servers;
+    std::shared_ptr<RpcStringPool> strings;
+    std::unordered_map<std::string_view, uint32_t> endpointIds;
+    std::unordered_map<const ProcessAttribution*, uint32_t> processIds;
+    /// @brief The copies of the records of one config generation, keyed by their address in that config
+    std::unordered_map<const RpcServerRecord*, const RpcServerRecord*> serverCopies;
+    uint64_t serverGeneration = 0;
+    /// @brief The latest copy per interface, reused when a reloaded config did not change the record
+    std::unordered_map<RpcUuid, const RpcServerRecord*, RpcUuidHash> latestServers;
+    std::vector<std::shared_ptr<const RpcEventSegment>> sealed;
+    std::vector<std::pair<RpcUuid, uint32_t>> tailInterfaces;
+    std::vector<std::pair<uint32_t, uint32_t>> tailProcesses;
+    uint64_t tailMinTimestamp = (std::numeric_limits<uint64_t>::max)();
+    uint64_t tailMaxTimestamp = 0;
+    mutable std::shared_ptr<const RpcEventSegment> tailSegment;
+
+    /*!
+     * @brief Index the tail rows
+     * @return std::shared_ptr<const RpcEventSegment> The segment
+     */
+    std::shared_ptr<const RpcEventSegment> buildTailSegment() const;
+
+    /*!
+     * @brief Get the store's copy of a server record
+     * @param record The record, owned by a config
+     * @param generation The generation of that config, 0 if unknown
+     * @return const RpcServerRecord* The copy, its strings point into the store's pool
+     */
+    const RpcServerRecord* internServer(const RpcServerRecord& record, uint64_t generation);
+};
+
+#endif // RPCEVENTSTORE_H
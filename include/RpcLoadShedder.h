@@ -0,0 +1,130 @@
+#ifndef RPCLOADSHEDDER_H
+#define RPCLOADSHEDDER_H
+
+#include "../include/RpcUuid.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/// @brief RpcSamplingOptions struct to configure sampling and load shedding of RPC events \struct RpcSamplingOptions
+struct RpcSamplingOptions
+{
+    /// @brief The probability of keeping an event while sampling, 1 keeps every event
+    double UniformRate = 1.0;
+    /// @brief The events per second each interface may keep while sampling, 0 turns the token buckets off
+    double InterfaceRate = 2000.0;
+    /// @brief The number of events an interface may keep in a burst
+    double InterfaceBurst = 4000.0;
+    /// @brief Sample only while the ingest queue is deep, otherwise sample all the time
+    bool Adaptive = true;
+    /// @brief The queue depth that switches sampling on
+    size_t HighWatermark = 8192;
+    /// @brief The queue depth that switches sampling off again
+    size_t LowWatermark = 1024;
+    /// @brief The lowest uniform rate adaptive sampling halves down to while the queue stays deep
+    double MinimumRate = 1.0 / 64;
+    /// @brief The time between two adjustments of the uniform rate
+    std::chrono::milliseconds AdjustInterval{ 20 };
+    /// @brief The time the queue must stay at or below LowWatermark at the configured rate before sampling switches off
+    std::chrono::milliseconds RecoveryInterval{ 1000 };
+};
+
+/// @brief RpcLoadShedder class to decide which RPC events are processed when they arrive faster than they can be \class RpcLoadShedder
+/// @note Every kept event carries a weight so that weighted aggregates stay unbiased: 1 / rate for uniform sampling, plus
+///       the weight of the events of the same interface dropped by its token bucket or shed since its last kept event.
+///       Not thread safe except for the counters, all other calls come from the producer thread.
+class RpcLoadShedder
+{
+public:
+    explicit RpcLoadShedder(const RpcSamplingOptions& options = RpcSamplingOptions());
+
+    /*!
+     * @brief Decide if an event is processed
+     * @param interfaceUuid The interface UUID of the event
+     * @param now The arrival time, refills the token buckets
+     * @param weight The number of events the kept event stands for
+     * @return bool True if the event should be processed, false if it was sampled out
+     */
+    bool admit(const RpcUuid& interfaceUuid, std::chrono::steady_clock::time_point now, double& weight);
+
+    /*!
+     * @brief Account for an admitted event that could not be queued, its weight moves to the next kept event of its interface
+     * @param interfaceUuid The interface UUID of the event
+     * @param weight The weight admit returned for it
+     */
+    void shed(const RpcUuid& interfaceUuid, double weight);
+
+    /*!
+     * @brief Switch adaptive sampling on or off and adjust its rate
+     * @param depth The current ingest queue depth
+     * @param now The current time
+     */
+    void updateQueueDepth(size_t depth, std::chrono::steady_clock::time_point now);
+
+    /*!
+     * @brief Check if sampling currently applies
+     * @return bool True if events are being sampled, false if every event is kept
+     */
+    bool sampling() const;
+
+    /*!
+     * @brief Get the current uniform sampling rate
+     * @return double The probability of keeping an event, 1 while sampling is off
+     */
+    double rate() const;
+
+    /*!
+     * @brief Get the number of events offered to admit
+     * @return uint64_t The event count
+     */
+    uint64_t seenEvents() const;
+
+    /*!
+     * @brief Get the number of events kept and queued
+     * @return uint64_t The event count
+     */
+    uint64_t keptEvents() const;
+
+    /*!
+     * @brief Get the number of events dropped by uniform sampling or a token bucket
+     * @return uint64_t The event count
+     */
+    uint64_t sampledEvents() const;
+
+    /*!
+     * @brief Get the number of admitted events dropped because the ingest queue was full
+     * @return uint64_t The event count
+     */
+    uint64_t shedEvents() const;
+
+private:
+    /// @brief Bucket struct to store the token bucket and carried weight of one interface \struct Bucket
+    struct Bucket
+    {
+        double Tokens;
+        std::chrono::steady_clock::time_point LastRefill;
+        double PendingWeight;
+    };
+
+    RpcSamplingOptions m_options;
+    std::unordered_map<RpcUuid, Bucket, RpcUuidHash> buckets;
+    uint64_t randomState;
+    std::chrono::steady_clock::time_point lastAdjustment;
+    std::chrono::steady_clock::time_point shallowSince;
+    std::atomic<bool> m_sampling;
+    std::atomic<double> m_rate;
+    std::atomic<uint64_t> seenCount;
+    std::atomic<uint64_t> keptCount;
+    std::atomic<uint64_t> sampledCount;
+    std::atomic<uint64_t> shedCount;
+
+    /*!
+     * @brief Get a uniform number in [0, 1)
+     * @return double The number
+     */
+    double nextRandom();
+};
+
+#endif // RPCLOADSHEDDER_H
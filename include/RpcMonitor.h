@@ -2,32 +2,27 @@
 #define RPCMONITOR_H
 
 #include "../include/RpcServersConfig.h"
+#include "../include/RpcServersDatabase.h"
+#include "../include/RpcEventPipeline.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventIngest.h"
+#include "../include/RpcLoadShedder.h"
+#include "../include/BoundedQueue.h"
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <map>
+#include <memory>
 #include <mutex>
-
-/// @brief RpcEvent struct to store RPC event information \struct RpcEvent
-struct RpcEvent
-{
-    int ProcessId;
-    int ThreadId;
-    uint64_t Timestamp;
-    std::string InterfaceUuid;
-    int ProcedureNum;
-    std::string Endpoint;
-    std::string Protocol;
-    std::string FileName;
-    std::string ServiceDisplayName;
-    std::string ServiceName;
-    std::string ProcedureName;
-};
+#include <thread>
 
 /// @brief RpcMonitor class to monitor RPC events \class RpcMonitor
 class RpcMonitor
 {
 public:
     RpcMonitor(const RpcServersConfig& config);
+    RpcMonitor(std::shared_ptr<RpcServersDatabase> database, const RpcSamplingOptions& sampling = RpcSamplingOptions());
+    ~RpcMonitor();
     
     /*!
      * @brief Start the RPC monitor
@@ -35,40 +30,89 @@ public:
     void start();
     
     /*!
-     * @brief Stop the RPC monitor
+     * @brief Stop the RPC monitor, once it returns no ETW callback runs and every queued call is processed
      */
     void stop();
     
     /*!
-     * @brief Get the RPC events captured by the monitor
-     * @return std::vector<RpcEvent> The RPC events
+     * @brief Get a snapshot of the RPC events captured by the monitor, it shares storage with the monitor instead of copying the events
+     * @return RpcEventSnapshot The RPC events, see RpcEventSnapshot::query
      */
-    std::vector<RpcEvent> getEvents() const;
+    RpcEventSnapshot getEvents() const;
 
-private:
-    RpcServersConfig rpcServersConfig;
-    std::vector<RpcEvent> collectedEvents;
-    std::mutex lock;
+    /*!
+     * @brief Get the RPC servers database, reloads published to it are picked up while capturing
+     * @return RpcServersDatabase& The RPC servers database
+     */
+    RpcServersDatabase& getDatabase();
 
     /*!
-     * @brief Check if the event is an RPC client call
-     * @param eventCode The event code
-     * @return bool True if it's an RPC client call, false otherwise
+     * @brief Get the cache attributing process IDs to images and services
+     * @return const ProcessAttributionCache& The process attribution cache
      */
-    bool isRpcClientCall(int eventCode);
-    
+    const ProcessAttributionCache& getProcessCache() const;
+
+    /*!
+     * @brief Get the event snapshots published for the GUI, a single reader thread may call update() on it
+     * @return SnapshotBuffer<RpcEventSnapshot>& The event snapshots
+     */
+    SnapshotBuffer<RpcEventSnapshot>& getEventSnapshots();
+
+    /*!
+     * @brief Get a copy of the heavy hitter and endpoint cardinality sketch of the captured calls
+     * @return RpcTrafficSketch The traffic sketch
+     */
+    RpcTrafficSketch getTrafficSketch() const;
+
+    /*!
+     * @brief Get the sampling and load shedding state, its counters may be read from any thread
+     * @return const RpcLoadShedder& The load shedder
+     */
+    const RpcLoadShedder& getLoadShedder() const;
+
+    /*!
+     * @brief Publish a snapshot of the captured events if new ones arrived and the last one is old enough
+     * @param force Publish pending events even if the last snapshot is recent
+     * @note Called by the processing thread after every batch, every 50ms while idle and once more when it exits
+     */
+    void publishEvents(bool force = false);
+
+    /*!
+     * @brief ETW callback function to queue an RPC call for the processing thread, sampling and load shedding happen here
+     * @param eventId The event id
+     * @param version The event version
+     * @param data The event user data, decoded only if the call is admitted
+     * @param length The user data length in bytes
+     * @param record The RPC call with its ProcessId, ThreadId and Timestamp set
+     */
+    void etwCallback(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallRecord record);
+
+    /*!
+     * @brief Process callback function to keep the process attribution cache current
+     * @note The change is queued with the calls, so it applies to the calls queued after it and never to those before it
+     * @param processId The process ID
+     * @param timestamp The event timestamp
+     * @param started True for a process start, false for a process exit
+     */
+    void processCallback(uint32_t processId, uint64_t timestamp, bool started);
+
+private:
+    RpcEventPipeline pipeline;
+    RpcLoadShedder loadShedder;
+    BoundedQueue<RpcIngestRecord> ingestQueue;
+    std::thread processingThread;
+    uint64_t traceHandle = 0;
+    std::thread traceThread;
+
     /*!
-     * @brief Parse the RPC event from the event data
-     * @param event The event data
-     * @return RpcEvent The parsed RPC event
+     * @brief Close the ETW trace and wait until its ProcessTrace thread returned, so no callback still uses this monitor
      */
-    RpcEvent parseRpcEvent(const std::map<std::string, std::string>& event);
+    void closeTrace();
 
     /*!
-     * @brief ETW callback function to process the events
-     * @param event The event data
+     * @brief Processing thread function, resolves, attributes and stores the queued calls and applies the queued process changes in order
      */
-    void etwCallback(const std::map<std::string, std::string>& event);
+    void processCalls();
 };
 
 #endif // RPCMONITOR_H
\ No newline at end of file
@@ -1,25 +1,97 @@
 #ifndef RPCSERVERSCONFIG_H
 #define RPCSERVERSCONFIG_H
 
+#include "../include/RpcUuid.h"
+#include "../include/RpcStringPool.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
-#include <mutex>
+#include <memory>
+#include <unordered_map>
 
-/// @brief RpcEvent struct to store RPC event information \class RpcEvent
+/// @brief RpcServerRecord struct to store one RPC server interface, strings point into the config's string pool \struct RpcServerRecord
+struct RpcServerRecord
+{
+    RpcUuid InterfaceUuid;
+    std::string_view FileName;
+    std::string_view ServiceDisplayName;
+    std::string_view ServiceName;
+    std::vector<std::string_view> Procedures;
+};
+
+/// @brief RpcResolution struct to reference a resolved RPC server and procedure \struct RpcResolution
+struct RpcResolution
+{
+    const RpcServerRecord* Server = nullptr;
+    const std::string_view* ProcedureName = nullptr;
+};
+
+/// @brief RpcMergeConflict struct to store a disagreement between two sources for the same interface \struct RpcMergeConflict
+struct RpcMergeConflict
+{
+    std::string SourceFile;
+    std::string ExistingSourceFile;
+    RpcUuid InterfaceUuid;
+    std::string Field;
+    std::string ExistingValue;
+    std::string IncomingValue;
+};
+
+/// @brief RpcSourceFailure struct to store a source that could not be loaded and was left out of a merge \struct RpcSourceFailure
+struct RpcSourceFailure
+{
+    std::string SourceFile;
+    std::string Error;
+};
+
+/// @brief RpcServersConfig class to look up RPC servers by interface UUID \class RpcServersConfig
 class RpcServersConfig
 {
 public:
-    RpcServersConfig(const std::map<std::string, std::map<std::string, std::string>>& rpcServersMap);
-    
+    /*!
+     * @brief Construct the config from records
+     * @param records The records, for duplicate interfaces the last one wins
+     * @param strings The pool the record strings point into, kept alive together with the config. If null, the
+     *                strings are copied into a pool owned by the config, so the caller's storage may go away.
+     */
+    RpcServersConfig(std::vector<RpcServerRecord> records, std::shared_ptr<const RpcStringPool> strings = nullptr);
+
     /*!
      * @brief Get the RPC information based on the interface UUID and function opnum
      * @param interfaceUuid The interface UUID
      * @param funcOpnum The function opnum
      * @return std::map<std::string, std::string> The RPC information
      */
-    std::map<std::string, std::string> getRpcInfo(const std::string& interfaceUuid, int funcOpnum);
-    
+    std::map<std::string, std::string> getRpcInfo(const std::string& interfaceUuid, int funcOpnum) const;
+
+    /*!
+     * @brief Resolve the interface UUID and function opnum to a record handle
+     * @param interfaceUuid The interface UUID
+     * @param funcOpnum The function opnum
+     * @return RpcResolution The resolution, Server is null if the interface is unknown
+     * @note The handle stays valid as long as any copy of this config is alive
+     */
+    RpcResolution resolve(const RpcUuid& interfaceUuid, int funcOpnum) const;
+
+    /*!
+     * @brief Get the generation of this config, unique per loaded database
+     * @return uint64_t The generation
+     */
+    uint64_t generation() const;
+
+    /*!
+     * @brief Get the number of interfaces in the config
+     * @return size_t The interface count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Get the string pool holding the names of all interfaces and procedures
+     * @return const RpcStringPool& The string pool
+     */
+    const RpcStringPool& strings() const;
+
     /*!
      * @brief Load the RPC servers configuration from a file
      * @param filePath The file path
@@ -27,8 +99,28 @@ public:
      */
     static RpcServersConfig load(const std::string& filePath);
 
+    /*!
+     * @brief Load several RPC servers files in parallel and merge them into one configuration
+     * @param filePaths The file paths, earlier files take precedence
+     * @param conflicts Receives the fields on which a later file disagreed with an earlier one, may be null
+     * @param failures Receives the files that could not be read or parsed and were skipped, may be null
+     * @return RpcServersConfig The merged RPC servers configuration
+     * @note Interfaces are deduplicated by UUID and all strings are interned, a later file only
+     *       contributes procedures beyond the ones already known for an interface. Throws only if no file could be loaded.
+     */
+    static RpcServersConfig loadMany(const std::vector<std::string>& filePaths, std::vector<RpcMergeConflict>* conflicts = nullptr,
+        std::vector<RpcSourceFailure>* failures = nullptr);
+
 private:
-    std::map<std::string, std::map<std::string, std::string>> rpcServersMap;
+    struct Table
+    {
+        std::vector<RpcServerRecord> records;
+        std::unordered_map<RpcUuid, size_t, RpcUuidHash> index;
+        std::shared_ptr<const RpcStringPool> strings;
+    };
+
+    std::shared_ptr<const Table> table;
+    uint64_t tableGeneration;
 };
 
-#endif // RPCSERVERSCONFIG_H
\ No newline at end of file
+#endif // RPCSERVERSCONFIG_H
@@ -0,0 +1,103 @@
+#ifndef RPCSERVERSDATABASE_H
+#define RPCSERVERSDATABASE_H
+
+#include "../include/RpcServersConfig.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief RpcServersDatabase class to publish RPC servers configurations to running resolver threads \class RpcServersDatabase
+/// @note Configs are swapped atomically, an old config is freed once the last Reader holding it has moved on
+class RpcServersDatabase
+{
+public:
+    /// @brief Reader class giving one resolver thread lock free access to the current config \class Reader
+    class Reader
+    {
+    public:
+        Reader(const RpcServersDatabase& database);
+
+        /*!
+         * @brief Get the current config, picking up a newly published one if there is any
+         * @return const RpcServersConfig& The config, valid until the next call on this reader
+         */
+        const RpcServersConfig& current();
+
+    private:
+        const RpcServersDatabase& database;
+        std::shared_ptr<const RpcServersConfig> config;
+        uint64_t version;
+    };
+
+    RpcServersDatabase(const RpcServersConfig& config);
+    ~RpcServersDatabase();
+
+    RpcServersDatabase(const RpcServersDatabase&) = delete;
+    RpcServersDatabase& operator=(const RpcServersDatabase&) = delete;
+
+    /*!
+     * @brief Get the currently published config
+     * @return std::shared_ptr<const RpcServersConfig> The config
+     */
+    std::shared_ptr<const RpcServersConfig> snapshot() const;
+
+    /*!
+     * @brief Publish a new config, readers pick it up on their next lookup
+     * @param config The new config
+     */
+    void publish(const RpcServersConfig& config);
+
+    /*!
+     * @brief Load a config on a background thread and publish it once loaded
+     * @param filePath The file path
+     * @return bool True if the reload was started, false if another reload is still running
+     */
+    bool reloadAsync(const std::string& filePath);
+
+    /*!
+     * @brief Load and merge several configs on a background thread and publish the result once loaded
+     * @param filePaths The file paths, earlier files take precedence
+     * @return bool True if the reload was started, false if another reload is still running
+     */
+    bool reloadAsync(const std::vector<std::string>& filePaths);
+
+    /*!
+     * @brief Check if a background reload is running
+     * @return bool True if a reload is running, false otherwise
+     */
+    bool isReloading() const;
+
+    /*!
+     * @brief Get the error of the last background reload
+     * @return std::string The error message, empty if the last reload succeeded or none ran yet
+     */
+    std::string lastReloadError() const;
+
+    /*!
+     * @brief Get the files the last background reload skipped because they could not be loaded
+     * @return std::vector<RpcSourceFailure> The skipped files and why
+     */
+    std::vector<RpcSourceFailure> lastReloadFailures() const;
+
+    /*!
+     * @brief Get the number of configs published so far, including the initial one
+     * @return uint64_t The version
+     */
+    uint64_t version() const;
+
+private:
+    std::shared_ptr<const RpcServersConfig> currentConfig;
+    std::atomic<uint64_t> currentVersion;
+    std::atomic<bool> reloading;
+    std::thread reloadThread;
+    std::mutex reloadMutex;
+    std::string reloadError;
+    std::vector<RpcSourceFailure> reloadFailures;
+    mutable std::mutex reloadErrorMutex;
+};
+
+#endif // RPCSERVERSDATABASE_H
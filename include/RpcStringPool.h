@@ -0,0 +1,39 @@
+#ifndef RPCSTRINGPOOL_H
+#define RPCSTRINGPOOL_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+/// @brief RpcStringPool class to store each distinct string once \class RpcStringPool
+/// @note Returned views stay valid for the lifetime of the pool
+class RpcStringPool
+{
+public:
+    /*!
+     * @brief Intern a string
+     * @param value The string
+     * @return std::string_view The pooled copy of the string
+     */
+    std::string_view intern(std::string_view value);
+
+    /*!
+     * @brief Get the number of distinct strings in the pool
+     * @return size_t The string count
+     */
+    size_t size() const;
+
+    /*!
+     * @brief Get the number of characters stored in the pool
+     * @return size_t The character count
+     */
+    size_t bytes() const;
+
+private:
+    std::deque<std::string> storage;
+    std::unordered_set<std::string_view> lookup;
+    size_t storedBytes = 0;
+};
+
+#endif // RPCSTRINGPOOL_H
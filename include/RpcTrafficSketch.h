@@ -0,0 +1,115 @@
+#ifndef RPCTRAFFICSKETCH_H
+#define RPCTRAFFICSKETCH_H
+
+#include "../include/RpcUuid.h"
+#include "../include/SpaceSaving.h"
+#include "../include/HyperLogLog.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief RpcCallKey struct to identify one stream of RPC calls \struct RpcCallKey
+struct RpcCallKey
+{
+    RpcUuid InterfaceUuid;
+    int ProcedureNum = 0;
+    int ProcessId = 0;
+    std::string Endpoint;
+
+    bool operator==(const RpcCallKey& other) const
+    {
+        return InterfaceUuid == other.InterfaceUuid && ProcedureNum == other.ProcedureNum
+            && ProcessId == other.ProcessId && Endpoint == other.Endpoint;
+    }
+};
+
+/*!
+ * @brief Hash an endpoint with 64 bit FNV-1a
+ * @param endpoint The endpoint
+ * @return uint64_t The hash
+ * @note This hash is part of the sketch format: the HyperLogLog registers of two sketches only merge correctly if both
+ *       hashed their endpoints the same way, so it must not change with the compiler or standard library
+ */
+inline uint64_t rpcEndpointHash(const std::string& endpoint)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : endpoint)
+    {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/// @brief RpcCallKeyHash struct to hash RpcCallKey values \struct RpcCallKeyHash
+struct RpcCallKeyHash
+{
+    size_t operator()(const RpcCallKey& key) const
+    {
+        uint64_t h = RpcUuidHash()(key.InterfaceUuid);
+        h = HyperLogLog::mix(h ^ (static_cast<uint64_t>(static_cast<uint32_t>(key.ProcedureNum)) << 32 | static_cast<uint32_t>(key.ProcessId)));
+        return static_cast<size_t>(HyperLogLog::mix(h ^ rpcEndpointHash(key.Endpoint)));
+    }
+};
+
+/// @brief RpcTrafficSketch class to summarize RPC traffic of unbounded cardinality in bounded memory \class RpcTrafficSketch
+/// @note Heavy hitters come from a Space-Saving summary, see SpaceSaving for its error bound. Distinct endpoints are
+///       estimated per interface with one HyperLogLog each, so memory grows with the number of interfaces only.
+///       Endpoints are hashed with rpcEndpointHash, so sketches from different builds can be merged.
+class RpcTrafficSketch
+{
+public:
+    /*!
+     * @brief Construct the sketch
+     * @param heavyHitterCapacity The number of (interface, opnum, pid, endpoint) counters
+     * @param cardinalityPrecision The HyperLogLog precision used per interface
+     */
+    explicit RpcTrafficSketch(size_t heavyHitterCapacity = 1024, int cardinalityPrecision = 10);
+
+    /*!
+     * @brief Add a call
+     * @param key The call key
+     * @param weight The weight of the call, e.g. the inverse sampling rate
+     */
+    void add(const RpcCallKey& key, double weight = 1.0);
+
+    /*!
+     * @brief Merge a sketch built by another thread or from another capture
+     * @param other The other sketch, it must use the same cardinality precision
+     */
+    void merge(const RpcTrafficSketch& other);
+
+    /*!
+     * @brief Get the heaviest call streams
+     * @param count The maximum number of streams
+     * @return std::vector<SpaceSaving<RpcCallKey, RpcCallKeyHash>::Counter> The streams, heaviest first
+     */
+    std::vector<SpaceSaving<RpcCallKey, RpcCallKeyHash>::Counter> topCalls(size_t count) const;
+
+    /*!
+     * @brief Estimate the number of distinct endpoints that called an interface
+     * @param interfaceUuid The interface UUID
+     * @return double The estimate
+     */
+    double distinctEndpoints(const RpcUuid& interfaceUuid) const;
+
+    /*!
+     * @brief Get the total weight added
+     * @return double The total weight
+     */
+    double totalCalls() const;
+
+    /*!
+     * @brief Get the maximum overestimate of any heavy hitter count
+     * @return double The error bound
+     */
+    double errorBound() const;
+
+private:
+    int m_cardinalityPrecision;
+    SpaceSaving<RpcCallKey, RpcCallKeyHash> heavyHitters;
+    std::unordered_map<RpcUuid, HyperLogLog, RpcUuidHash> endpointsPerInterface;
+};
+
+#endif // RPCTRAFFICSKETCH_H
@@ -0,0 +1,46 @@
+#ifndef RPCUUID_H
+#define RPCUUID_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/// @brief RpcUuid struct to store an RPC interface UUID in binary form \struct RpcUuid
+struct RpcUuid
+{
+    uint64_t High = 0;
+    uint64_t Low = 0;
+
+    /*!
+     * @brief Parse a UUID string, with or without surrounding braces
+     * @param text The UUID string, e.g. "{12345778-1234-abcd-ef00-0123456789ab}"
+     * @param uuid The parsed UUID
+     * @return bool True if the string is a valid UUID, false otherwise
+     */
+    static bool parse(const std::string& text, RpcUuid& uuid);
+
+    /*!
+     * @brief Convert the UUID to its braced lower case string form
+     * @return std::string The UUID string
+     */
+    std::string toString() const;
+
+    bool operator==(const RpcUuid& other) const { return High == other.High && Low == other.Low; }
+    bool operator!=(const RpcUuid& other) const { return !(*this == other); }
+    bool operator<(const RpcUuid& other) const { return High < other.High || (High == other.High && Low < other.Low); }
+};
+
+/// @brief RpcUuidHash struct to hash RpcUuid values for unordered containers \struct RpcUuidHash
+struct RpcUuidHash
+{
+    size_t operator()(const RpcUuid& uuid) const
+    {
+        uint64_t h = uuid.High * 0x9e3779b97f4a7c15ULL ^ uuid.Low;
+        h ^= h >> 32;
+        h *= 0xd6e8feb86659fd93ULL;
+        h ^= h >> 32;
+        return static_cast<size_t>(h);
+    }
+};
+
+#endif // RPCUUID_H
@@ -0,0 +1,188 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// @brief SnapshotBuffer class to hand snapshots from one worker thread to one reader thread without locks \class SnapshotBuffer
+/// @note Triple buffered: the worker fills back() and publishes it, the reader picks up the latest published buffer
+///       with update(), neither side ever waits on the other
+template <typename T>
+class SnapshotBuffer
+{
+public:
+    /*!
+     * @brief Get the buffer the worker fills, it still holds an older snapshot
+     * @return T& The back buffer
+     */
+    T& back()
+    {
+        return buffers[backIndex];
+    }
+
+    /*!
+     * @brief Publish the back buffer, called by the worker
+     */
+    void publish()
+    {
+        const uint32_t previous = middleState.exchange(backIndex | FreshFlag, std::memory_order_acq_rel);
+        backIndex = previous & IndexMask;
+    }
+
+    /*!
+     * @brief Pick up the latest published buffer, called by the reader
+     * @return bool True if a new snapshot was picked up, false otherwise
+     */
+    bool update()
+    {
+        if (!(middleState.load(std::memory_order_acquire) & FreshFlag))
+        {
+            return false;
+        }
+
+        const uint32_t previous = middleState.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & IndexMask;
+        return true;
+    }
+
+    /*!
+     * @brief Get the snapshot the reader currently holds
+     * @return const T& The front buffer
+     */
+    const T& front() const
+    {
+        return buffers[frontIndex];
+    }
+
+private:
+    static constexpr uint32_t IndexMask = 3;
+    static constexpr uint32_t FreshFlag = 4;
+
+    T buffers[3];
+    std::atomic<uint32_t> middleState{ 1 };
+    uint32_t backIndex = 2;
+    uint32_t frontIndex = 0;
+};
+
+/// @brief RowSnapshot class to store an immutable view of an append only list of rows \class RowSnapshot
+/// @note Full chunks are shared between snapshots, so publishing costs one chunk copy instead of a copy of all rows
+template <typename Row>
+class RowSnapshot
+{
+public:
+    static constexpr size_t ChunkBits = 10;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+
+    /*!
+     * @brief Get the number of rows
+     * @return size_t The row count
+     */
+    size_t size() const
+    {
+        return rowCount;
+    }
+
+    /*!
+     * @brief Get a row
+     * @param index The row index
+     * @return const Row& The row
+     */
+    const Row& operator[](size_t index) const
+    {
+        return (*chunks[index >> ChunkBits])[index & (ChunkSize - 1)];
+    }
+
+    /*!
+     * @brief Get the generation of the rows, it changes when the list is replaced instead of appended to
+     * @return uint64_t The generation
+     */
+    uint64_t generation() const
+    {
+        return rowGeneration;
+    }
+
+private:
+    template <typename> friend class RowSnapshotBuilder;
+
+    std::vector<std::shared_ptr<const std::vector<Row>>> chunks;
+    size_t rowCount = 0;
+    uint64_t rowGeneration = 0;
+};
+
+/// @brief RowSnapshotBuilder class to append rows and cut RowSnapshots of them \class RowSnapshotBuilder
+template <typename Row>
+class RowSnapshotBuilder
+{
+public:
+    /*!
+     * @brief Append a row
+     * @param row The row
+     */
+    void append(Row row)
+    {
+        tail.push_back(std::move(row));
+        rowCount++;
+        if (tail.size() == RowSnapshot<Row>::ChunkSize)
+        {
+            sealed.push_back(std::make_shared<const std::vector<Row>>(std::move(tail)));
+            tail = std::vector<Row>();
+        }
+    }
+
+    /*!
+     * @brief Drop all rows and start a new generation
+     */
+    void reset()
+    {
+        sealed.clear();
+        tail.clear();
+        rowCount = 0;
+        rowGeneration++;
+    }
+
+    /*!
+     * @brief Get the number of rows
+     * @return size_t The row count
+     */
+    size_t size() const
+    {
+        return rowCount;
+    }
+
+    /*!
+     * @brief Get a row
+     * @param index The row index
+     * @return const Row& The row
+     */
+    const Row& operator[](size_t index) const
+    {
+        const size_t chunk = index >> RowSnapshot<Row>::ChunkBits;
+        const size_t offset = index & (RowSnapshot<Row>::ChunkSize - 1);
+        return chunk < sealed.size() ? (*sealed[chunk])[offset] : tail[offset];
+    }
+
+    /*!
+     * @brief Write a snapshot of the current rows
+     * @param snapshot The snapshot to overwrite, typically the back buffer of a SnapshotBuffer
+     */
+    void snapshot(RowSnapshot<Row>& snapshot) const
+    {
+        snapshot.chunks = sealed;
+        if (!tail.empty())
+        {
+            snapshot.chunks.push_back(std::make_shared<const std::vector<Row>>(tail));
+        }
+        snapshot.rowCount = rowCount;
+        snapshot.rowGeneration = rowGeneration;
+    }
+
+private:
+    std::vector<std::shared_ptr<const std::vector<Row>>> sealed;
+    std::vector<Row> tail;
+    size_t rowCount = 0;
+    uint64_t rowGeneration = 1;
+};
+
+#endif // SNAPSHOTBUFFER_H
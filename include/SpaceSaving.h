@@ -0,0 +1,221 @@
+#ifndef SPACESAVING_H
+#define SPACESAVING_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief SpaceSaving class to track the heaviest keys of a stream in fixed memory \class SpaceSaving
+/// @note With capacity k and total weight N every reported count overestimates the true weight of its key
+///       by at most its Error, which is bounded by N / k, and every key heavier than N / k is reported
+template <typename Key, typename Hash = std::hash<Key>>
+class SpaceSaving
+{
+public:
+    /// @brief Counter struct to store a tracked key \struct Counter
+    struct Counter
+    {
+        Key Item;
+        double Count;
+        double Error;
+    };
+
+    /*!
+     * @brief Construct the summary
+     * @param capacity The number of counters
+     */
+    explicit SpaceSaving(size_t capacity = 1024) : capacity((std::max)(capacity, size_t(1)))
+    {
+        heap.reserve(this->capacity);
+        positions.reserve(this->capacity);
+    }
+
+    /*!
+     * @brief Add weight to a key
+     * @param key The key
+     * @param weight The weight, e.g. the inverse sampling rate of the event
+     */
+    void add(const Key& key, double weight = 1.0)
+    {
+        totalWeight += weight;
+
+        auto it = positions.find(key);
+        if (it != positions.end())
+        {
+            heap[it->second].Count += weight;
+            siftDown(it->second);
+            return;
+        }
+
+        if (heap.size() < capacity)
+        {
+            heap.push_back({ key, weight, 0.0 });
+            positions[key] = heap.size() - 1;
+            siftUp(heap.size() - 1);
+            return;
+        }
+
+        // evict the minimum, the newcomer inherits its count as error
+        Counter& minimum = heap[0];
+        positions.erase(minimum.Item);
+        minimum.Error = minimum.Count;
+        minimum.Count += weight;
+        minimum.Item = key;
+        positions[key] = 0;
+        siftDown(0);
+    }
+
+    /*!
+     * @brief Merge another summary into this one, the error bound becomes the sum of both bounds
+     * @param other The other summary
+     */
+    void merge(const SpaceSaving& other)
+    {
+        const double ownMinimum = heap.size() < capacity ? 0.0 : heap[0].Count;
+        const double otherMinimum = other.heap.size() < other.capacity ? 0.0 : other.heap[0].Count;
+
+        std::unordered_map<Key, Counter, Hash> combined;
+        combined.reserve(heap.size() + other.heap.size());
+        for (const auto& counter : heap)
+        {
+            combined.emplace(counter.Item, Counter{ counter.Item, counter.Count + otherMinimum, counter.Error + otherMinimum });
+        }
+        for (const auto& counter : other.heap)
+        {
+            auto it = combined.find(counter.Item);
+            if (it != combined.end())
+            {
+                it->second.Count += counter.Count - otherMinimum;
+                it->second.Error += counter.Error - otherMinimum;
+            }
+            else
+            {
+                combined.emplace(counter.Item, Counter{ counter.Item, counter.Count + ownMinimum, counter.Error + ownMinimum });
+            }
+        }
+
+        std::vector<Counter> counters;
+        counters.reserve(combined.size());
+        for (auto& entry : combined)
+        {
+            counters.push_back(std::move(entry.second));
+        }
+
+        const size_t keep = (std::min)(capacity, counters.size());
+        std::nth_element(counters.begin(), counters.begin() + (keep - (keep > 0 ? 1 : 0)), counters.end(),
+            [](const Counter& a, const Counter& b) { return a.Count > b.Count; });
+        counters.resize(keep);
+
+        heap = std::move(counters);
+        positions.clear();
+        for (size_t i = 0; i < heap.size(); i++)
+        {
+            positions[heap[i].Item] = i;
+        }
+        for (size_t i = heap.size() / 2; i-- > 0;)
+        {
+            siftDown(i);
+        }
+        totalWeight += other.totalWeight;
+    }
+
+    /*!
+     * @brief Get the heaviest keys
+     * @param count The maximum number of keys to return
+     * @return std::vector<Counter> The counters, heaviest first
+     */
+    std::vector<Counter> top(size_t count) const
+    {
+        std::vector<Counter> counters(heap.begin(), heap.end());
+        const size_t keep = (std::min)(count, counters.size());
+        std::partial_sort(counters.begin(), counters.begin() + keep, counters.end(),
+            [](const Counter& a, const Counter& b) { return a.Count > b.Count; });
+        counters.resize(keep);
+        return counters;
+    }
+
+    /*!
+     * @brief Get the total weight added, including merged summaries
+     * @return double The total weight
+     */
+    double total() const
+    {
+        return totalWeight;
+    }
+
+    /*!
+     * @brief Get the maximum overestimate of any reported count
+     * @return double The error bound
+     */
+    double errorBound() const
+    {
+        return totalWeight / static_cast<double>(capacity);
+    }
+
+    /*!
+     * @brief Get the approximate memory held by the summary
+     * @return size_t The byte count, without memory the keys own on the heap
+     */
+    size_t bytes() const
+    {
+        // an unordered_map node holds the value, the next pointer and usually the cached hash
+        return heap.capacity() * sizeof(Counter) + positions.bucket_count() * sizeof(void*)
+            + positions.size() * (sizeof(std::pair<const Key, size_t>) + 2 * sizeof(void*));
+    }
+
+private:
+    size_t capacity;
+    double totalWeight = 0.0;
+    std::vector<Counter> heap;
+    std::unordered_map<Key, size_t, Hash> positions;
+
+    void swapCounters(size_t a, size_t b)
+    {
+        std::swap(heap[a], heap[b]);
+        positions[heap[a].Item] = a;
+        positions[heap[b].Item] = b;
+    }
+
+    void siftUp(size_t index)
+    {
+        while (index > 0)
+        {
+            const size_t parent = (index - 1) / 2;
+            if (heap[parent].Count <= heap[index].Count)
+            {
+                break;
+            }
+            swapCounters(parent, index);
+            index = parent;
+        }
+    }
+
+    void siftDown(size_t index)
+    {
+        for (;;)
+        {
+            const size_t left = 2 * index + 1;
+            const size_t right = left + 1;
+            size_t smallest = index;
+            if (left < heap.size() && heap[left].Count < heap[smallest].Count)
+            {
+                smallest = left;
+            }
+            if (right < heap.size() && heap[right].Count < heap[smallest].Count)
+            {
+                smallest = right;
+            }
+            if (smallest == index)
+            {
+                break;
+            }
+            swapCounters(smallest, index);
+            index = smallest;
+        }
+    }
+};
+
+#endif // SPACESAVING_H
@@ -0,0 +1,44 @@
+#ifndef WINDOWSPROCESSINFOPROVIDER_H
+#define WINDOWSPROCESSINFOPROVIDER_H
+
+#include "../include/ProcessAttributionCache.h"
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief WindowsProcessInfoProvider class to query process images and hosted services on Windows \class WindowsProcessInfoProvider
+/// @note The service table is enumerated once and only refreshed for processes that started after the last enumeration,
+///       at most once per refresh interval. A process the table is too old for is reported as provisional, so the cache
+///       asks again once the table may be refreshed instead of keeping it without its services.
+class WindowsProcessInfoProvider : public ProcessInfoProvider
+{
+public:
+    /*!
+     * @brief Construct the provider
+     * @param refreshInterval The minimum time between two enumerations of the services
+     */
+    explicit WindowsProcessInfoProvider(std::chrono::steady_clock::duration refreshInterval = std::chrono::seconds(1));
+
+    /*!
+     * @brief Query the image path, start time and hosted services of a process
+     * @param processId The process ID
+     * @param attribution The attribution, StartTime is the process creation time as FILETIME
+     * @return bool True if the process was found, false otherwise
+     */
+    bool query(uint32_t processId, ProcessAttribution& attribution) override;
+
+private:
+    std::map<uint32_t, std::vector<std::pair<std::string, std::string>>> servicesByProcess;
+    uint64_t servicesSnapshotTime = 0;
+    std::chrono::steady_clock::duration m_refreshInterval;
+    std::chrono::steady_clock::time_point lastRefresh;
+
+    /*!
+     * @brief Enumerate the running services and the processes hosting them
+     */
+    void refreshServices();
+};
+
+#endif // WINDOWSPROCESSINFOPROVIDER_H
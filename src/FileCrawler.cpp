@@ -1,26 +1,71 @@
 #include "../include/FileCrawler.h"
-#include <windows.h>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#ifdef _WIN32
+#include <windows.h>
 #include <rpc.h>
 #include <rpcdcep.h>
 #include <tchar.h>
 #include <winsvc.h>
 
 #pragma comment(lib, "rpcrt4.lib")
+#else
+#include <filesystem>
+#endif
 
 FileCrawler::FileCrawler(const std::string& rootDir) : m_rootDir(rootDir) {}
 
 std::vector<std::string> FileCrawler::findFiles(const std::vector<std::string>& extensions)
 {
     std::vector<std::string> foundFiles;
-    searchDirectory(m_rootDir, extensions, foundFiles);
+    findFiles(extensions, [&foundFiles](const std::string& filePath) { foundFiles.push_back(filePath); });
     return foundFiles;
 }
 
-void FileCrawler::searchDirectory(const std::string& dir, const std::vector<std::string>& extensions, std::vector<std::string>& foundFiles)
+void FileCrawler::findFiles(const std::vector<std::string>& extensions, const std::function<void(const std::string&)>& onFound)
+{
+    searchDirectory(m_rootDir, extensions, onFound);
+}
+
+bool FileCrawler::endsWith(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
+}
+
+#ifndef _WIN32
+void FileCrawler::searchDirectory(const std::string& dir, const std::vector<std::string>& extensions, const std::function<void(const std::string&)>& onFound)
+{
+    // without the RPC runtime there is nothing to query, so only the extension decides
+    std::error_code error;
+    std::filesystem::recursive_directory_iterator it(dir, std::filesystem::directory_options::skip_permission_denied, error);
+    if (error)
+    {
+        std::cerr << "Error accessing directory: " << dir << ". " << error.message() << std::endl;
+        return;
+    }
+
+    for (const auto& entry : it)
+    {
+        if (!entry.is_regular_file(error))
+        {
+            continue;
+        }
+
+        const std::string fileName = entry.path().filename().string();
+        for (const auto& ext : extensions)
+        {
+            if (endsWith(fileName, ext))
+            {
+                onFound(entry.path().string());
+                break;
+            }
+        }
+    }
+}
+#else
+void FileCrawler::searchDirectory(const std::string& dir, const std::vector<std::string>& extensions, const std::function<void(const std::string&)>& onFound)
 {
     WIN32_FIND_DATAA findFileData;
     HANDLE hFind;
@@ -45,7 +90,7 @@ void FileCrawler::searchDirectory(const std::string& dir, const std::vector<std:
             {
                 continue;
             }
-            searchDirectory(fullPath, extensions, foundFiles);
+            searchDirectory(fullPath, extensions, onFound);
         }
         else
         {
@@ -53,7 +98,7 @@ void FileCrawler::searchDirectory(const std::string& dir, const std::vector<std:
             {
                 if (endsWith(fileName, ext) && isRpcRelatedFile(fullPath))
                 {
-                    foundFiles.push_back(fullPath);
+                    onFound(fullPath);
                     break;
                 }
             }
@@ -83,11 +128,6 @@ std::string FileCrawler::getErrorMessage(DWORD errorCode)
     return std::string();
 }
 
-bool FileCrawler::endsWith(const std::string& str, const std::string& suffix)
-{
-    return str.size() >= suffix.size() && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
-}
-
 bool FileCrawler::isRpcRelatedFile(const std::string& filePath)
 {
     RPC_STATUS status;
@@ -174,3 +214,4 @@ bool FileCrawler::checkExecutableServicePath(const std::string& filePath)
     CloseServiceHandle(scManager);
     return false;
 }
+#endif
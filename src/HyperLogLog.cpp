@@ -0,0 +1,89 @@
+#include "../include/HyperLogLog.h"
+#include <algorithm>
+#include <cmath>
+
+HyperLogLog::HyperLogLog(int precision)
+    : m_precision((std::min)((std::max)(precision, 4), 16)), registers(size_t(1) << m_precision, 0) {}
+
+void HyperLogLog::add(uint64_t hash)
+{
+    const size_t index = static_cast<size_t>(hash >> (64 - m_precision));
+    const uint64_t rest = (hash << m_precision) | (uint64_t(1) << (m_precision - 1));
+
+    // rank is the position of the first set bit in the remaining bits, the guard bit keeps it bounded
+    uint8_t rank = 1;
+    for (uint64_t bit = uint64_t(1) << 63; !(rest & bit); bit >>= 1)
+    {
+        rank++;
+    }
+
+    if (rank > registers[index])
+    {
+        registers[index] = rank;
+    }
+}
+
+double HyperLogLog::estimate() const
+{
+    const double m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t value : registers)
+    {
+        sum += std::ldexp(1.0, -value);
+        if (value == 0)
+        {
+            zeros++;
+        }
+    }
+
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    if (registers.size() == 16)
+    {
+        alpha = 0.673;
+    }
+    else if (registers.size() == 32)
+    {
+        alpha = 0.697;
+    }
+    else if (registers.size() == 64)
+    {
+        alpha = 0.709;
+    }
+
+    const double raw = alpha * m * m / sum;
+
+    // linear counting is more accurate while many registers are still empty
+    if (raw <= 2.5 * m && zeros > 0)
+    {
+        return m * std::log(m / static_cast<double>(zeros));
+    }
+    return raw;
+}
+
+bool HyperLogLog::merge(const HyperLogLog& other)
+{
+    if (other.m_precision != m_precision)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < registers.size(); i++)
+    {
+        registers[i] = (std::max)(registers[i], other.registers[i]);
+    }
+    return true;
+}
+
+int HyperLogLog::precision() const
+{
+    return m_precision;
+}
+
+uint64_t HyperLogLog::mix(uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
@@ -0,0 +1,215 @@
+#include "../include/ProcessAttributionCache.h"
+#include <limits>
+
+ProcessAttributionCache::ProcessAttributionCache(std::unique_ptr<ProcessInfoProvider> provider, size_t bucketCount,
+    std::chrono::steady_clock::duration negativeLifetime)
+    : provider(std::move(provider)), m_negativeLifetime(negativeLifetime), bucketMask(0), activeReaders(0), entryCount(0),
+      hitCount(0), missCount(0), invalidationCount(0)
+{
+    size_t size = 1;
+    while (size < bucketCount)
+    {
+        size <<= 1;
+    }
+
+    buckets = std::vector<std::atomic<const Node*>>(size);
+    for (auto& bucket : buckets)
+    {
+        bucket.store(nullptr, std::memory_order_relaxed);
+    }
+    bucketMask = size - 1;
+}
+
+ProcessAttributionCache::~ProcessAttributionCache()
+{
+    for (auto& bucket : buckets)
+    {
+        const Node* node = bucket.load(std::memory_order_relaxed);
+        while (node)
+        {
+            const Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    for (const Node* node : retiredNodes)
+    {
+        delete node;
+    }
+}
+
+std::shared_ptr<const ProcessAttribution> ProcessAttributionCache::lookup(uint32_t processId, uint64_t timestamp)
+{
+    std::shared_ptr<const ProcessAttribution> attribution = find(processId, std::chrono::steady_clock::now());
+    if (attribution)
+    {
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        attribution = fill(processId);
+    }
+
+    if (timestamp != 0 && attribution->StartTime > timestamp)
+    {
+        return nullptr;
+    }
+    return attribution;
+}
+
+void ProcessAttributionCache::onProcessStart(uint32_t processId, uint64_t startTime)
+{
+    std::lock_guard<std::mutex> guard(writerMutex);
+    invalidationCount++;
+    removeLocked(processId, startTime);
+}
+
+void ProcessAttributionCache::onProcessExit(uint32_t processId)
+{
+    std::lock_guard<std::mutex> guard(writerMutex);
+    invalidationCount++;
+    removeLocked(processId, std::numeric_limits<uint64_t>::max());
+}
+
+size_t ProcessAttributionCache::size() const
+{
+    return entryCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ProcessAttributionCache::hits() const
+{
+    return hitCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ProcessAttributionCache::misses() const
+{
+    return missCount.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const ProcessAttribution> ProcessAttributionCache::fill(uint32_t processId)
+{
+    // the provider has its own lock, so lock free lookups and start and exit events go on while it is queried
+    std::lock_guard<std::mutex> providerGuard(providerMutex);
+    std::shared_ptr<const ProcessAttribution> attribution = find(processId, std::chrono::steady_clock::now());
+    if (attribution)
+    {
+        hitCount.fetch_add(1, std::memory_order_relaxed);
+        return attribution;
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t invalidationsBefore;
+    {
+        std::lock_guard<std::mutex> guard(writerMutex);
+        invalidationsBefore = invalidationCount;
+    }
+
+    auto queried = std::make_shared<ProcessAttribution>();
+    const bool found = provider && provider->query(processId, *queried);
+    if (!found)
+    {
+        *queried = ProcessAttribution();
+    }
+    queried->ProcessId = processId;
+
+    std::lock_guard<std::mutex> guard(writerMutex);
+    // a start or exit event during the query may have made the answer stale, use it once but do not cache it
+    if (invalidationCount != invalidationsBefore)
+    {
+        return queried;
+    }
+
+    // an expired unknown entry is replaced, unknown and provisional processes are cached briefly so a vanished PID does
+    // not hit the provider on every event, yet a PID the provider could not fully see yet gets another chance
+    removeLocked(processId, std::numeric_limits<uint64_t>::max());
+    const auto expiresAt = found && !queried->Provisional ? std::chrono::steady_clock::time_point::max()
+                                 : std::chrono::steady_clock::now() + m_negativeLifetime;
+    std::atomic<const Node*>& bucket = bucketFor(processId);
+    const Node* node = new Node{ processId, queried, expiresAt, bucket.load(std::memory_order_relaxed) };
+    bucket.store(node, std::memory_order_release);
+    entryCount.fetch_add(1, std::memory_order_relaxed);
+    return queried;
+}
+
+std::shared_ptr<const ProcessAttribution> ProcessAttributionCache::find(uint32_t processId, std::chrono::steady_clock::time_point now)
+{
+    activeReaders.fetch_add(1, std::memory_order_seq_cst);
+
+    std::shared_ptr<const ProcessAttribution> attribution;
+    for (const Node* node = bucketFor(processId).load(std::memory_order_seq_cst); node; node = node->next)
+    {
+        if (node->processId == processId)
+        {
+            if (node->expiresAt > now)
+            {
+                attribution = node->attribution;
+            }
+            break;
+        }
+    }
+
+    activeReaders.fetch_sub(1, std::memory_order_release);
+    return attribution;
+}
+
+void ProcessAttributionCache::removeLocked(uint32_t processId, uint64_t olderThan)
+{
+    std::atomic<const Node*>& bucket = bucketFor(processId);
+    const Node* head = bucket.load(std::memory_order_relaxed);
+
+    bool found = false;
+    for (const Node* node = head; node; node = node->next)
+    {
+        if (node->processId == processId && node->attribution->StartTime < olderThan)
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        return;
+    }
+
+    // nodes are immutable, so the chain is rebuilt without the process and the old chain is retired
+    const Node* newHead = nullptr;
+    const Node** tail = &newHead;
+    for (const Node* node = head; node; node = node->next)
+    {
+        if (node->processId != processId)
+        {
+            Node* copy = new Node{ node->processId, node->attribution, node->expiresAt, nullptr };
+            *tail = copy;
+            tail = &copy->next;
+        }
+        retiredNodes.push_back(node);
+    }
+
+    bucket.store(newHead, std::memory_order_seq_cst);
+    entryCount.fetch_sub(1, std::memory_order_relaxed);
+    reclaimLocked();
+}
+
+void ProcessAttributionCache::reclaimLocked()
+{
+    // a reader that enters after the unlink cannot reach retired nodes, so an idle moment makes them safe to free
+    if (activeReaders.load(std::memory_order_seq_cst) != 0)
+    {
+        return;
+    }
+
+    for (const Node* node : retiredNodes)
+    {
+        delete node;
+    }
+    retiredNodes.clear();
+}
+
+std::atomic<const ProcessAttributionCache::Node*>& ProcessAttributionCache::bucketFor(uint32_t processId)
+{
+    // Windows PIDs are multiples of four, fold them before masking
+    const uint32_t hash = (processId >> 2) * 0x9e3779b1U;
+    return buckets[(hash >> 16 ^ hash) & bucketMask];
+}
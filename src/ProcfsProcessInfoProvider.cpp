@@ -0,0 +1,59 @@
+#include "../include/ProcfsProcessInfoProvider.h"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+ProcfsProcessInfoProvider::ProcfsProcessInfoProvider(const std::string& procRoot) : m_procRoot(procRoot) {}
+
+bool ProcfsProcessInfoProvider::query(uint32_t processId, ProcessAttribution& attribution)
+{
+    const std::string processDir = m_procRoot + "/" + std::to_string(processId);
+
+    std::ifstream statFile(processDir + "/stat");
+    std::string stat;
+    if (!statFile.is_open() || !std::getline(statFile, stat))
+    {
+        return false;
+    }
+
+    // the command name may contain spaces, fields after it are counted from the closing parenthesis
+    const size_t commEnd = stat.rfind(')');
+    if (commEnd == std::string::npos)
+    {
+        return false;
+    }
+
+    std::istringstream fields(stat.substr(commEnd + 2));
+    std::string field;
+    for (int i = 3; i <= 22 && fields >> field; i++)
+    {
+        if (i == 22)
+        {
+            attribution.StartTime = std::stoull(field);
+        }
+    }
+
+    char imagePath[4096];
+    const ssize_t imagePathLength = readlink((processDir + "/exe").c_str(), imagePath, sizeof(imagePath));
+    if (imagePathLength > 0)
+    {
+        attribution.ImagePath.assign(imagePath, static_cast<size_t>(imagePathLength));
+    }
+
+    std::ifstream cgroupFile(processDir + "/cgroup");
+    std::string cgroup;
+    while (std::getline(cgroupFile, cgroup))
+    {
+        const size_t unitEnd = cgroup.rfind(".service");
+        if (unitEnd != std::string::npos)
+        {
+            const size_t unitBegin = cgroup.rfind('/', unitEnd) + 1;
+            attribution.ServiceName = cgroup.substr(unitBegin, unitEnd - unitBegin);
+            attribution.ServiceDisplayName = cgroup.substr(unitBegin);
+            break;
+        }
+    }
+
+    attribution.ProcessId = processId;
+    return true;
+}
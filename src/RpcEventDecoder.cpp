@@ -0,0 +1,100 @@
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventSchema.h"
+
+uint32_t readUInt32(const uint8_t* data)
+{
+    return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8
+        | static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+static void appendUtf8(std::string& result, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        result.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        result.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        result.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+    else
+    {
+        result.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+        result.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+        result.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+}
+
+RpcUuid readGuid(const uint8_t* data)
+{
+    RpcUuid uuid;
+    uuid.High = static_cast<uint64_t>(readUInt32(data)) << 32
+        | static_cast<uint64_t>(data[4] | data[5] << 8) << 16
+        | static_cast<uint64_t>(data[6] | data[7] << 8);
+    for (int i = 8; i < 16; i++)
+    {
+        uuid.Low = (uuid.Low << 8) | data[i];
+    }
+    return uuid;
+}
+
+std::string readUtf16String(const uint8_t* data, size_t length, size_t& bytesRead)
+{
+    std::string result;
+    size_t offset = 0;
+    while (offset + 2 <= length)
+    {
+        uint32_t unit = static_cast<uint32_t>(data[offset] | data[offset + 1] << 8);
+        offset += 2;
+        if (unit == 0)
+        {
+            break;
+        }
+
+        if (unit >= 0xd800 && unit < 0xdc00 && offset + 2 <= length)
+        {
+            const uint32_t low = static_cast<uint32_t>(data[offset] | data[offset + 1] << 8);
+            if (low >= 0xdc00 && low < 0xe000)
+            {
+                unit = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+                offset += 2;
+            }
+        }
+        appendUtf8(result, unit);
+    }
+
+    bytesRead = offset;
+    return result;
+}
+
+bool decodeRpcEvent(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallPayload& payload)
+{
+    const RpcPayloadDecoder decoder = RpcEventDecoders::find(eventId, version);
+    return decoder != nullptr && decoder(data, length, payload);
+}
+
+bool peekRpcInterface(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcUuid& interfaceUuid)
+{
+    const RpcEventLayout layout = RpcEventDecoders::layout(eventId, version);
+    if (layout.Decode == nullptr || length < layout.FixedLength)
+    {
+        return false;
+    }
+
+    interfaceUuid = readGuid(data + layout.InterfaceUuidOffset);
+    return true;
+}
+
+bool decodeRpcCallPayload(const uint8_t* data, size_t length, RpcCallPayload& payload)
+{
+    // the newest layout, it also reads payloads of older versions that stop after Endpoint
+    return decodeRpcEvent(RpcClientCallStartEventId, (std::numeric_limits<uint8_t>::max)(), data, length, payload);
+}
@@ -0,0 +1,29 @@
+#include "../include/RpcEventIngest.h"
+#include <utility>
+
+bool ingestRpcEvent(RpcLoadShedder& shedder, BoundedQueue<RpcIngestRecord>& queue, uint16_t eventId, uint8_t version,
+    const uint8_t* data, size_t length, RpcCallRecord record, std::chrono::steady_clock::time_point now)
+{
+    RpcUuid interfaceUuid;
+    if (!peekRpcInterface(eventId, version, data, length, interfaceUuid))
+    {
+        return false;
+    }
+
+    shedder.updateQueueDepth(queue.size(), now);
+    double weight;
+    if (!shedder.admit(interfaceUuid, now, weight))
+    {
+        return false;
+    }
+
+    // the peek checked the fixed prefix, so the decode accepts the payload
+    decodeRpcEvent(eventId, version, data, length, record.Payload);
+    record.Weight = weight;
+    if (!queue.push(RpcIngestRecord(std::move(record))))
+    {
+        shedder.shed(interfaceUuid, weight);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,113 @@
+#include "../include/RpcEventPipeline.h"
+#include <string>
+#include <utility>
+
+RpcEventPipeline::RpcEventPipeline(std::shared_ptr<RpcServersDatabase> database, std::unique_ptr<ProcessInfoProvider> provider)
+    : database(std::move(database)), databaseReader(*this->database), processCache(std::move(provider)) {}
+
+void RpcEventPipeline::process(const RpcCallRecord& record)
+{
+    const RpcServersConfig& config = databaseReader.current();
+    const RpcEvent rpcEvent = parseRpcEvent(record, config);
+    const std::shared_ptr<const ProcessAttribution> attribution = processCache.lookup(record.ProcessId, record.Timestamp);
+
+    RpcCallKey callKey;
+    callKey.InterfaceUuid = record.Payload.InterfaceUuid;
+    callKey.ProcedureNum = static_cast<int>(record.Payload.ProcNum);
+    callKey.ProcessId = static_cast<int>(record.ProcessId);
+    callKey.Endpoint = record.Payload.Endpoint;
+
+    std::lock_guard<std::mutex> guard(lock);
+    trafficSketch.add(callKey, record.Weight);
+    collectedEvents.append(rpcEvent, record.Payload.Endpoint, attribution, &config);
+    snapshotPending = true;
+}
+
+void RpcEventPipeline::process(const RpcProcessChange& change)
+{
+    if (change.Started)
+    {
+        processCache.onProcessStart(change.ProcessId, change.Timestamp);
+    }
+    else
+    {
+        processCache.onProcessExit(change.ProcessId);
+    }
+}
+
+void RpcEventPipeline::process(const RpcIngestRecord& record)
+{
+    std::visit([this](const auto& item) { process(item); }, record);
+}
+
+void RpcEventPipeline::publishEvents(bool force)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (!snapshotPending || (!force && now - lastSnapshotTime < std::chrono::milliseconds(50)))
+    {
+        return;
+    }
+
+    {
+        // getEvents snapshots from other threads and shares the cached tail index
+        std::lock_guard<std::mutex> guard(lock);
+        collectedEvents.snapshot(eventSnapshots.back());
+    }
+    eventSnapshots.publish();
+    lastSnapshotTime = now;
+    snapshotPending = false;
+}
+
+RpcEventSnapshot RpcEventPipeline::getEvents() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    RpcEventSnapshot events;
+    collectedEvents.snapshot(events);
+    return events;
+}
+
+size_t RpcEventPipeline::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return collectedEvents.size();
+}
+
+RpcServersDatabase& RpcEventPipeline::getDatabase()
+{
+    return *database;
+}
+
+ProcessAttributionCache& RpcEventPipeline::getProcessCache()
+{
+    return processCache;
+}
+
+const ProcessAttributionCache& RpcEventPipeline::getProcessCache() const
+{
+    return processCache;
+}
+
+RpcTrafficSketch RpcEventPipeline::getTrafficSketch() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return trafficSketch;
+}
+
+SnapshotBuffer<RpcEventSnapshot>& RpcEventPipeline::getEventSnapshots()
+{
+    return eventSnapshots;
+}
+
+RpcEvent RpcEventPipeline::parseRpcEvent(const RpcCallRecord& record, const RpcServersConfig& config)
+{
+    RpcEvent rpcEvent;
+    rpcEvent.ProcessId = record.ProcessId;
+    rpcEvent.ThreadId = record.ThreadId;
+    rpcEvent.Timestamp = record.Timestamp;
+    rpcEvent.InterfaceUuid = record.Payload.InterfaceUuid;
+    rpcEvent.ProcedureNum = static_cast<uint16_t>(record.Payload.ProcNum);
+    rpcEvent.Protocol = static_cast<uint16_t>(record.Payload.Protocol);
+    rpcEvent.Weight = static_cast<float>(record.Weight);
+    rpcEvent.Server = config.resolve(record.Payload.InterfaceUuid, rpcEvent.ProcedureNum).Server;
+    return rpcEvent;
+}
@@ -0,0 +1,329 @@
+#include "../include/RpcEventStore.h"
+#include <atomic>
+
+std::string_view RpcEvent::procedureName() const
+{
+    if (!Server || ProcedureNum >= Server->Procedures.size())
+    {
+        return "";
+    }
+    return Server->Procedures[ProcedureNum];
+}
+
+std::string_view RpcEvent::fileName() const
+{
+    return Server ? Server->FileName : std::string_view("");
+}
+
+const RowSnapshot<RpcEvent>& RpcEventSnapshot::rows() const
+{
+    return contents().Rows;
+}
+
+size_t RpcEventSnapshot::size() const
+{
+    return contents().Rows.size();
+}
+
+RpcEventRange RpcEventSnapshot::query(RpcEventQuery query) const&
+{
+    return RpcEventRange(*this, std::move(query));
+}
+
+RpcEventRange RpcEventSnapshot::query(RpcEventQuery query) &&
+{
+    return RpcEventRange(std::move(*this), std::move(query));
+}
+
+std::string_view RpcEventSnapshot::endpoint(const RpcEvent& event) const
+{
+    return contents().Endpoints[event.EndpointId];
+}
+
+const ProcessAttribution* RpcEventSnapshot::process(const RpcEvent& event) const
+{
+    return contents().Processes[event.ProcessInfoId].get();
+}
+
+const RpcEventSnapshot::Contents& RpcEventSnapshot::contents() const
+{
+    static const Contents empty;
+    return m_contents ? *m_contents : empty;
+}
+
+RpcEventIterator::RpcEventIterator(std::shared_ptr<const RpcEventQueryState> state)
+    : state(std::move(state)), contents(&this->state->Snapshot.contents()), query(&this->state->Query)
+{
+    // every segment before the first one whose running maximum reaches From ends before the range
+    const auto& segments = contents->Segments;
+    auto first = std::lower_bound(segments.begin(), segments.end(), query->From,
+        [](const std::shared_ptr<const RpcEventSegment>& segment, uint64_t from) { return segment->MaxTimestampSoFar < from; });
+    segmentIndex = static_cast<size_t>(first - segments.begin());
+
+    enterSegment();
+    advance();
+}
+
+void RpcEventIterator::enterSegment()
+{
+    const auto& segments = contents->Segments;
+    for (; segmentIndex < segments.size(); segmentIndex++)
+    {
+        const RpcEventSegment& segment = *segments[segmentIndex];
+        if (segment.MaxTimestamp < query->From || segment.MinTimestamp > query->To)
+        {
+            continue;
+        }
+
+        std::pair<const uint32_t*, const uint32_t*> interfaceRows{ nullptr, nullptr };
+        std::pair<const uint32_t*, const uint32_t*> processRows{ nullptr, nullptr };
+        if (query->InterfaceUuid)
+        {
+            interfaceRows = segment.Interfaces.find(*query->InterfaceUuid);
+            if (interfaceRows.first == interfaceRows.second)
+            {
+                continue;
+            }
+        }
+        if (query->ProcessId)
+        {
+            processRows = segment.Processes.find(*query->ProcessId);
+            if (processRows.first == processRows.second)
+            {
+                continue;
+            }
+        }
+
+        useIndex = query->InterfaceUuid || query->ProcessId;
+        useFilter = query->InterfaceUuid && query->ProcessId;
+        if (useFilter)
+        {
+            // walk the shorter posting list and probe the longer one
+            if (processRows.second - processRows.first < interfaceRows.second - interfaceRows.first)
+            {
+                std::swap(interfaceRows, processRows);
+            }
+            candidate = interfaceRows.first;
+            candidateEnd = interfaceRows.second;
+            filterBegin = processRows.first;
+            filterEnd = processRows.second;
+        }
+        else if (useIndex)
+        {
+            const auto& rows = query->InterfaceUuid ? interfaceRows : processRows;
+            candidate = rows.first;
+            candidateEnd = rows.second;
+        }
+        else
+        {
+            scanRow = 0;
+            scanEnd = segment.RowCount;
+        }
+        return;
+    }
+}
+
+void RpcEventIterator::advance()
+{
+    const auto& segments = contents->Segments;
+    while (segmentIndex < segments.size())
+    {
+        if (useIndex ? candidate == candidateEnd : scanRow == scanEnd)
+        {
+            segmentIndex++;
+            candidate = candidateEnd = nullptr;
+            scanRow = scanEnd = 0;
+            enterSegment();
+            continue;
+        }
+        const uint32_t offset = useIndex ? *candidate++ : scanRow++;
+
+        if (useFilter && !std::binary_search(filterBegin, filterEnd, offset))
+        {
+            continue;
+        }
+
+        const size_t row = segments[segmentIndex]->FirstRow + offset;
+        const RpcEvent& event = contents->Rows[row];
+        if (event.Timestamp < query->From || event.Timestamp > query->To)
+        {
+            continue;
+        }
+        if (query->Predicate && !query->Predicate(event))
+        {
+            continue;
+        }
+
+        currentRow = row;
+        return;
+    }
+
+    currentRow = EndRow;
+}
+
+RpcEventStore::RpcEventStore()
+    : strings(std::make_shared<RpcStringPool>())
+{
+    // handle 0 stands for a call without attribution
+    processes.append(nullptr);
+}
+
+void RpcEventStore::append(RpcEvent event, std::string_view endpoint, const std::shared_ptr<const ProcessAttribution>& process,
+    const RpcServersConfig* config)
+{
+    auto endpointId = endpointIds.find(endpoint);
+    if (endpointId == endpointIds.end())
+    {
+        const std::string_view pooled = strings->intern(endpoint);
+        endpointId = endpointIds.emplace(pooled, static_cast<uint32_t>(endpoints.size())).first;
+        endpoints.append(pooled);
+    }
+    event.EndpointId = endpointId->second;
+
+    event.ProcessInfoId = 0;
+    if (process)
+    {
+        // the cache hands out one attribution per process, holding on to it keeps its address from being reused
+        auto processId = processIds.find(process.get());
+        if (processId == processIds.end())
+        {
+            processId = processIds.emplace(process.get(), static_cast<uint32_t>(processes.size())).first;
+            processes.append(process);
+        }
+        event.ProcessInfoId = processId->second;
+    }
+
+    if (event.Server)
+    {
+        event.Server = internServer(*event.Server, config ? config->generation() : 0);
+    }
+
+    const uint32_t offset = static_cast<uint32_t>(tailInterfaces.size());
+    tailInterfaces.emplace_back(event.InterfaceUuid, offset);
+    tailProcesses.emplace_back(event.ProcessId, offset);
+    tailMinTimestamp = (std::min)(tailMinTimestamp, event.Timestamp);
+    tailMaxTimestamp = (std::max)(tailMaxTimestamp, event.Timestamp);
+    rows.append(event);
+
+    if (tailInterfaces.size() == SegmentRows)
+    {
+        sealed.push_back(buildTailSegment());
+        tailInterfaces.clear();
+        tailProcesses.clear();
+        tailMinTimestamp = (std::numeric_limits<uint64_t>::max)();
+        tailMaxTimestamp = 0;
+        tailSegment.reset();
+    }
+}
+
+size_t RpcEventStore::size() const
+{
+    return rows.size();
+}
+
+const RpcEvent& RpcEventStore::operator[](size_t index) const
+{
+    return rows[index];
+}
+
+void RpcEventStore::snapshot(RpcEventSnapshot& snapshot) const
+{
+    // contents nobody else shares, like a back buffer that was handed back, are overwritten to keep their capacity
+    std::shared_ptr<RpcEventSnapshot::Contents> contents = std::move(snapshot.m_contents);
+    if (contents && contents.use_count() == 1)
+    {
+        // pairs with the release of the last other owner, its reads happened before we write
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    else
+    {
+        contents = std::make_shared<RpcEventSnapshot::Contents>();
+    }
+    rows.snapshot(contents->Rows);
+    endpoints.snapshot(contents->Endpoints);
+    processes.snapshot(contents->Processes);
+    servers.snapshot(contents->Servers);
+    contents->Strings = strings;
+    contents->Segments = sealed;
+
+    if (!tailInterfaces.empty())
+    {
+        // the tail is re-indexed only when it grew since the last snapshot
+        if (!tailSegment || tailSegment->RowCount != tailInterfaces.size())
+        {
+            tailSegment = buildTailSegment();
+        }
+        contents->Segments.push_back(tailSegment);
+    }
+    snapshot.m_contents = std::move(contents);
+}
+
+size_t RpcEventStore::bytes() const
+{
+    size_t total = rows.size() * sizeof(RpcEvent) + endpoints.size() * sizeof(std::string_view) + strings->bytes();
+    for (size_t index = 0; index < servers.size(); index++)
+    {
+        total += sizeof(RpcServerRecord) + servers[index]->Procedures.capacity() * sizeof(std::string_view);
+    }
+    for (const auto& segment : sealed)
+    {
+        total += sizeof(RpcEventSegment) + segment->Interfaces.bytes() + segment->Processes.bytes();
+    }
+    return total;
+}
+
+std::shared_ptr<const RpcEventSegment> RpcEventStore::buildTailSegment() const
+{
+    auto segment = std::make_shared<RpcEventSegment>();
+    segment->RowCount = static_cast<uint32_t>(tailInterfaces.size());
+    segment->FirstRow = rows.size() - segment->RowCount;
+    segment->MinTimestamp = tailMinTimestamp;
+    segment->MaxTimestamp = tailMaxTimestamp;
+    segment->MaxTimestampSoFar = sealed.empty() ? tailMaxTimestamp : (std::max)(sealed.back()->MaxTimestampSoFar, tailMaxTimestamp);
+    segment->Interfaces.build(tailInterfaces);
+    segment->Processes.build(tailProcesses);
+    return segment;
+}
+
+const RpcServerRecord* RpcEventStore::internServer(const RpcServerRecord& record, uint64_t generation)
+{
+    // addresses are only unique within one config, a freed config's records may be reallocated by the next one
+    if (generation != serverGeneration)
+    {
+        serverCopies.clear();
+        serverGeneration = generation;
+    }
+
+    if (generation != 0)
+    {
+        auto copy = serverCopies.find(&record);
+        if (copy != serverCopies.end())
+        {
+            return copy->second;
+        }
+    }
+
+    const RpcServerRecord*& latest = latestServers[record.InterfaceUuid];
+    if (!latest || latest->FileName != record.FileName || latest->ServiceDisplayName != record.ServiceDisplayName
+        || latest->ServiceName != record.ServiceName || latest->Procedures != record.Procedures)
+    {
+        auto server = std::make_shared<RpcServerRecord>();
+        server->InterfaceUuid = record.InterfaceUuid;
+        server->FileName = strings->intern(record.FileName);
+        server->ServiceDisplayName = strings->intern(record.ServiceDisplayName);
+        server->ServiceName = strings->intern(record.ServiceName);
+        server->Procedures.reserve(record.Procedures.size());
+        for (std::string_view procedure : record.Procedures)
+        {
+            server->Procedures.push_back(strings->intern(procedure));
+        }
+        latest = server.get();
+        servers.append(std::move(server));
+    }
+
+    if (generation != 0)
+    {
+        serverCopies.emplace(&record, latest);
+    }
+    return latest;
+}
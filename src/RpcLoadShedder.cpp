@@ -0,0 +1,164 @@
+#include "../include/RpcLoadShedder.h"
+#include <algorithm>
+
+// the producer thread is the only writer, so a relaxed load and store is enough for readers on other threads
+static void bump(std::atomic<uint64_t>& counter, int64_t delta = 1)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + static_cast<uint64_t>(delta), std::memory_order_relaxed);
+}
+
+RpcLoadShedder::RpcLoadShedder(const RpcSamplingOptions& options)
+    : m_options(options), randomState(0x9e3779b97f4a7c15ULL), m_sampling(!options.Adaptive),
+      m_rate(1.0), seenCount(0), keptCount(0), sampledCount(0), shedCount(0)
+{
+    m_options.UniformRate = (std::min)(1.0, (std::max)(options.UniformRate, 1e-6));
+    m_options.MinimumRate = (std::min)(m_options.UniformRate, (std::max)(options.MinimumRate, 1e-6));
+    m_rate.store(options.Adaptive ? 1.0 : m_options.UniformRate, std::memory_order_relaxed);
+}
+
+bool RpcLoadShedder::admit(const RpcUuid& interfaceUuid, std::chrono::steady_clock::time_point now, double& weight)
+{
+    bump(seenCount);
+
+    auto it = buckets.find(interfaceUuid);
+    if (it == buckets.end())
+    {
+        it = buckets.emplace(interfaceUuid, Bucket{ m_options.InterfaceBurst, now, 0.0 }).first;
+    }
+    Bucket& bucket = it->second;
+
+    weight = 1.0;
+    if (m_sampling.load(std::memory_order_relaxed))
+    {
+        const double rate = m_rate.load(std::memory_order_relaxed);
+        if (rate < 1.0)
+        {
+            if (nextRandom() >= rate)
+            {
+                bump(sampledCount);
+                return false;
+            }
+            weight = 1.0 / rate;
+        }
+
+        if (m_options.InterfaceRate > 0.0)
+        {
+            const double elapsed = std::chrono::duration<double>(now - bucket.LastRefill).count();
+            bucket.Tokens = (std::min)(m_options.InterfaceBurst, bucket.Tokens + elapsed * m_options.InterfaceRate);
+            bucket.LastRefill = now;
+            if (bucket.Tokens < 1.0)
+            {
+                bucket.PendingWeight += weight;
+                bump(sampledCount);
+                return false;
+            }
+            bucket.Tokens -= 1.0;
+        }
+    }
+
+    weight += bucket.PendingWeight;
+    bucket.PendingWeight = 0.0;
+    bump(keptCount);
+    return true;
+}
+
+void RpcLoadShedder::shed(const RpcUuid& interfaceUuid, double weight)
+{
+    auto it = buckets.find(interfaceUuid);
+    if (it != buckets.end())
+    {
+        it->second.PendingWeight += weight;
+    }
+    bump(keptCount, -1);
+    bump(shedCount);
+}
+
+void RpcLoadShedder::updateQueueDepth(size_t depth, std::chrono::steady_clock::time_point now)
+{
+    if (!m_options.Adaptive)
+    {
+        return;
+    }
+
+    if (!m_sampling.load(std::memory_order_relaxed))
+    {
+        if (depth >= m_options.HighWatermark)
+        {
+            m_rate.store(m_options.UniformRate, std::memory_order_relaxed);
+            m_sampling.store(true, std::memory_order_relaxed);
+            lastAdjustment = now;
+            shallowSince = now;
+        }
+        return;
+    }
+
+    if (depth > m_options.LowWatermark)
+    {
+        shallowSince = now;
+    }
+    if (now - lastAdjustment < m_options.AdjustInterval)
+    {
+        return;
+    }
+
+    // halve the rate while the queue stays deep and win it back slowly once it drained, so it settles instead of flapping
+    const double rate = m_rate.load(std::memory_order_relaxed);
+    if (depth >= m_options.HighWatermark)
+    {
+        m_rate.store((std::max)(m_options.MinimumRate, rate / 2), std::memory_order_relaxed);
+        lastAdjustment = now;
+    }
+    else if (depth <= m_options.LowWatermark)
+    {
+        if (rate < m_options.UniformRate)
+        {
+            m_rate.store((std::min)(m_options.UniformRate, rate * 1.25), std::memory_order_relaxed);
+        }
+        else if (now - shallowSince >= m_options.RecoveryInterval)
+        {
+            m_sampling.store(false, std::memory_order_relaxed);
+            m_rate.store(1.0, std::memory_order_relaxed);
+        }
+        lastAdjustment = now;
+    }
+}
+
+bool RpcLoadShedder::sampling() const
+{
+    return m_sampling.load(std::memory_order_relaxed);
+}
+
+double RpcLoadShedder::rate() const
+{
+    return m_rate.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLoadShedder::seenEvents() const
+{
+    return seenCount.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLoadShedder::keptEvents() const
+{
+    return keptCount.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLoadShedder::sampledEvents() const
+{
+    return sampledCount.load(std::memory_order_relaxed);
+}
+
+uint64_t RpcLoadShedder::shedEvents() const
+{
+    return shedCount.load(std::memory_order_relaxed);
+}
+
+double RpcLoadShedder::nextRandom()
+{
+    // splitmix64, so the sampled subset of a replayed capture is reproducible
+    uint64_t z = (randomState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return static_cast<double>(z >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -1,29 +1,54 @@
 #include "../include/RpcMonitor.h"
+#include "../include/WindowsProcessInfoProvider.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventSchema.h"
 #include <windows.h>
 #include <evntrace.h>
 #include <tdh.h>
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <mutex>
 #include <thread>
 
-RpcMonitor::RpcMonitor(const RpcServersConfig& config) : rpcServersConfig(config) {}
+RpcMonitor::RpcMonitor(const RpcServersConfig& config)
+    : RpcMonitor(std::make_shared<RpcServersDatabase>(config)) {}
+
+RpcMonitor::RpcMonitor(std::shared_ptr<RpcServersDatabase> database, const RpcSamplingOptions& sampling)
+    : pipeline(std::move(database), std::make_unique<WindowsProcessInfoProvider>()),
+      loadShedder(sampling), ingestQueue(4 * sampling.HighWatermark) {}
+
+RpcMonitor::~RpcMonitor()
+{
+    closeTrace();
+    ingestQueue.close();
+    if (processingThread.joinable())
+    {
+        processingThread.join();
+    }
+}
 
 TRACEHANDLE sessionHandle = 0;
 VOID WINAPI EtwEventCallback(PEVENT_RECORD eventRecord);
 const GUID SystemTraceControlGuid = { 0x9e814c01, 0x5b65, 0x11d0, {0x8f, 0x20, 0x00, 0xaa, 0x00, 0x3e, 0x00, 0x00} };
+const GUID ProcessProviderGuid = { 0x3d6fa8d0, 0xfe05, 0x11d0, {0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c} };
 
-std::string GuidToString(const GUID& guid)
+RpcUuid GuidToRpcUuid(const GUID& guid)
 {
-    char buffer[64] = { 0 };
-    snprintf(buffer, sizeof(buffer),
-        "{%08x-%04x-%04x-%04x-%012llx}",
-        guid.Data1, guid.Data2, guid.Data3,
-        (guid.Data4[0] << 8) | guid.Data4[1],
-        *((uint64_t*)(&guid.Data4[2])));
+    RpcUuid uuid;
+    uuid.High = (static_cast<uint64_t>(guid.Data1) << 32) | (static_cast<uint64_t>(guid.Data2) << 16) | guid.Data3;
+    for (int i = 0; i < 8; i++)
+    {
+        uuid.Low = (uuid.Low << 8) | guid.Data4[i];
+    }
+    return uuid;
+}
 
-    return std::string(buffer);
+std::string GuidToString(const GUID& guid)
+{
+    return GuidToRpcUuid(guid).toString();
 }
 
 void RpcMonitor::start()
@@ -43,7 +68,7 @@ void RpcMonitor::start()
     sessionProperties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
     sessionProperties->Wnode.ClientContext = 1;
     sessionProperties->Wnode.Guid = SystemTraceControlGuid;
-    sessionProperties->EnableFlags = EVENT_TRACE_FLAG_NETWORK_TCPIP;
+    sessionProperties->EnableFlags = EVENT_TRACE_FLAG_NETWORK_TCPIP | EVENT_TRACE_FLAG_PROCESS;
     sessionProperties->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
     sessionProperties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
 
@@ -64,22 +89,25 @@ void RpcMonitor::start()
     logFile.LoggerName = KERNEL_LOGGER_NAME;
     logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
     logFile.EventRecordCallback = EtwEventCallback;
+    logFile.Context = this;
 
-    TRACEHANDLE traceHandle = OpenTrace(&logFile);
-    if (traceHandle == INVALID_PROCESSTRACE_HANDLE)
+    const TRACEHANDLE openedTrace = OpenTrace(&logFile);
+    if (openedTrace == INVALID_PROCESSTRACE_HANDLE)
     {
         StopTrace(sessionHandle, KERNEL_LOGGER_NAME, sessionProperties);
         free(sessionProperties);
         throw std::runtime_error("Failed to open ETW trace. Error: " + std::to_string(GetLastError()));
     }
+    free(sessionProperties);
+
+    // the worker runs before the first callback can queue a call
+    processingThread = std::thread(&RpcMonitor::processCalls, this);
 
-    std::thread traceThread([traceHandle]() {
-        TRACEHANDLE handles[1] = { traceHandle };
+    traceHandle = openedTrace;
+    traceThread = std::thread([openedTrace]() {
+        TRACEHANDLE handles[1] = { openedTrace };
         ProcessTrace(handles, 1, nullptr, nullptr);
     });
-
-    traceThread.detach();
-    free(sessionProperties);
 }
 
 void RpcMonitor::stop()
@@ -99,42 +127,138 @@ void RpcMonitor::stop()
     sessionProperties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
 
     ULONG status = StopTrace(sessionHandle, KERNEL_LOGGER_NAME, sessionProperties);
+    free(sessionProperties);
+
+    // callbacks hold this monitor as their context, none may run once stop returns
+    closeTrace();
+
+    // the worker drains what is already queued before it exits
+    ingestQueue.close();
+    if (processingThread.joinable())
+    {
+        processingThread.join();
+    }
+
     if (status != ERROR_SUCCESS)
     {
-        free(sessionProperties);
         throw std::runtime_error("Failed to stop ETW session. Error: " + std::to_string(status));
     }
+}
 
-    free(sessionProperties);
+void RpcMonitor::closeTrace()
+{
+    if (!traceThread.joinable())
+    {
+        return;
+    }
+
+    // ProcessTrace returns once the buffers delivered before CloseTrace are processed
+    const ULONG status = CloseTrace(traceHandle);
+    if (status != ERROR_SUCCESS && status != ERROR_CTX_CLOSE_PENDING)
+    {
+        std::cerr << "Failed to close ETW trace. Error: " << status << std::endl;
+    }
+    traceThread.join();
+    traceHandle = 0;
 }
 
-bool RpcMonitor::isRpcClientCall(int eventCode)
+RpcEventSnapshot RpcMonitor::getEvents() const
 {
-    // RPC client calls are event ID 5
-    return eventCode == 5;
+    return pipeline.getEvents();
 }
 
-std::vector<RpcEvent> RpcMonitor::getEvents() const
+RpcServersDatabase& RpcMonitor::getDatabase()
 {
-    return collectedEvents;
+    return pipeline.getDatabase();
+}
+
+const ProcessAttributionCache& RpcMonitor::getProcessCache() const
+{
+    return pipeline.getProcessCache();
+}
+
+RpcTrafficSketch RpcMonitor::getTrafficSketch() const
+{
+    return pipeline.getTrafficSketch();
+}
+
+SnapshotBuffer<RpcEventSnapshot>& RpcMonitor::getEventSnapshots()
+{
+    return pipeline.getEventSnapshots();
+}
+
+const RpcLoadShedder& RpcMonitor::getLoadShedder() const
+{
+    return loadShedder;
+}
+
+void RpcMonitor::publishEvents(bool force)
+{
+    // the processing thread calls this at least every 50ms, so a quiet capture still publishes its last batch
+    pipeline.publishEvents(force);
 }
 
 VOID WINAPI EtwEventCallback(PEVENT_RECORD eventRecord)
 {
-    std::cout << "Event received, Event ID: " << eventRecord->EventHeader.EventDescriptor.Id << std::endl;
+    RpcMonitor* monitor = static_cast<RpcMonitor*>(eventRecord->UserContext);
+    const USHORT eventId = eventRecord->EventHeader.EventDescriptor.Id;
 
-    if (eventRecord->EventHeader.EventDescriptor.Id == 5)
+    if (monitor && IsEqualGUID(eventRecord->EventHeader.ProviderId, ProcessProviderGuid))
     {
-        std::cout << "RPC Client Call detected" << std::endl;
-        auto event = std::map<std::string, std::string>();
-        for (ULONG i = 0; i < eventRecord->UserDataLength; i++)
+        // Process_TypeGroup1 starts with the pointer sized UniqueProcessKey followed by ProcessId
+        const UCHAR opcode = eventRecord->EventHeader.EventDescriptor.Opcode;
+        const ULONG pointerSize = (eventRecord->EventHeader.Flags & EVENT_HEADER_FLAG_64_BIT_HEADER) ? 8 : 4;
+        if ((opcode == EVENT_TRACE_TYPE_START || opcode == EVENT_TRACE_TYPE_END) && eventRecord->UserDataLength >= pointerSize + sizeof(ULONG))
         {
-            event["Field" + std::to_string(i)] = std::to_string(((PBYTE)eventRecord->UserData)[i]);
+            ULONG processId = 0;
+            memcpy(&processId, static_cast<const BYTE*>(eventRecord->UserData) + pointerSize, sizeof(ULONG));
+            monitor->processCallback(processId, eventRecord->EventHeader.TimeStamp.QuadPart, opcode == EVENT_TRACE_TYPE_START);
         }
+        return;
     }
+
+    // only RPC client calls are captured, their payload layout depends on the event version
+    if (!monitor || eventId != RpcClientCallStartEventId)
+    {
+        return;
+    }
+
+    RpcCallRecord record;
+    record.ProcessId = eventRecord->EventHeader.ProcessId;
+    record.ThreadId = eventRecord->EventHeader.ThreadId;
+    record.Timestamp = eventRecord->EventHeader.TimeStamp.QuadPart;
+    monitor->etwCallback(eventId, eventRecord->EventHeader.EventDescriptor.Version,
+        static_cast<const uint8_t*>(eventRecord->UserData), eventRecord->UserDataLength, std::move(record));
+}
+
+void RpcMonitor::etwCallback(uint16_t eventId, uint8_t version, const uint8_t* data, size_t length, RpcCallRecord record)
+{
+    // the payload is only decoded once the call is admitted, so sampling bounds the time spent on the ETW thread
+    ingestRpcEvent(loadShedder, ingestQueue, eventId, version, data, length, std::move(record), std::chrono::steady_clock::now());
+}
+
+void RpcMonitor::processCalls()
+{
+    std::vector<RpcIngestRecord> batch;
+    while (ingestQueue.popAll(batch, std::chrono::milliseconds(50)))
+    {
+        for (const auto& record : batch)
+        {
+            pipeline.process(record);
+        }
+        publishEvents();
+    }
+
+    // the last batch before stop may have been throttled, the view must still show it
+    publishEvents(true);
 }
 
-void RpcMonitor::etwCallback(const std::map<std::string, std::string>& event)
+void RpcMonitor::processCallback(uint32_t processId, uint64_t timestamp, bool started)
 {
-    // TODO: IMPLEMENT THIS!
+    // process changes are rare and a dropped one would misattribute every later call of the PID, so they skip the capacity
+    RpcProcessChange change;
+    change.ProcessId = processId;
+    change.Timestamp = timestamp;
+    change.Started = started;
+    ingestQueue.push(change, true);
 }
@@ -1,66 +1,290 @@
 #include "../include/RpcServersConfig.h"
 #include "../externals/json/single_include/nlohmann/json.hpp"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <thread>
 
 using json = nlohmann::json;
 
-RpcServersConfig::RpcServersConfig(const std::map<std::string, std::map<std::string, std::string>>& rpcServersMap) 
-    : rpcServersMap(rpcServersMap) {}
+static std::atomic<uint64_t> nextGeneration(1);
 
-std::map<std::string, std::string> RpcServersConfig::getRpcInfo(const std::string& interfaceUuid, int funcOpnum)
+/// @brief ParsedRpcServer struct to hold one interface of a file before it is merged \struct ParsedRpcServer
+struct ParsedRpcServer
 {
-    auto it = rpcServersMap.find(interfaceUuid);
-    if (it == rpcServersMap.end())
+    RpcUuid InterfaceUuid;
+    std::string FileName;
+    std::string ServiceDisplayName;
+    std::string ServiceName;
+    std::vector<std::string> Procedures;
+};
+
+static std::vector<ParsedRpcServer> parseRpcServersFile(const std::string& filePath)
+{
+    std::ifstream rpcServersFile(filePath);
+    if (!rpcServersFile.is_open())
+    {
+        throw std::runtime_error("Could not open file: " + filePath);
+    }
+
+    json root;
+    rpcServersFile >> root;
+
+    std::vector<ParsedRpcServer> servers;
+    servers.reserve(root.size());
+
+    for (const auto& rpcServer : root)
+    {
+        ParsedRpcServer server;
+        const std::string uuidString = rpcServer["InterfaceUuid"].get<std::string>();
+        if (!RpcUuid::parse(uuidString, server.InterfaceUuid))
+        {
+            std::cerr << "Skipping invalid interface UUID: " << uuidString << " in " << filePath << std::endl;
+            continue;
+        }
+
+        server.FileName = rpcServer["FileName"].get<std::string>();
+        server.ServiceDisplayName = rpcServer["ServiceDisplayName"].get<std::string>();
+        server.ServiceName = rpcServer["ServiceName"].get<std::string>();
+
+        for (const auto& procedure : rpcServer["Procedures"])
+        {
+            server.Procedures.push_back(procedure.value("Name", std::string()));
+        }
+
+        servers.push_back(std::move(server));
+    }
+
+    return servers;
+}
+
+static void recordConflict(std::vector<RpcMergeConflict>* conflicts, const std::string& sourceFile, const std::string& existingSourceFile,
+    const RpcUuid& interfaceUuid, const std::string& field, std::string_view existingValue, std::string_view incomingValue)
+{
+    if (conflicts)
+    {
+        conflicts->push_back({ sourceFile, existingSourceFile, interfaceUuid, field, std::string(existingValue), std::string(incomingValue) });
+    }
+}
+
+RpcServersConfig::RpcServersConfig(std::vector<RpcServerRecord> records, std::shared_ptr<const RpcStringPool> strings)
+    : tableGeneration(nextGeneration.fetch_add(1))
+{
+    auto newTable = std::make_shared<Table>();
+    if (strings)
+    {
+        newTable->strings = std::move(strings);
+    }
+    else
+    {
+        // the views point at storage the caller owns, a config must never outlive the strings it references
+        auto ownStrings = std::make_shared<RpcStringPool>();
+        for (auto& record : records)
+        {
+            record.FileName = ownStrings->intern(record.FileName);
+            record.ServiceDisplayName = ownStrings->intern(record.ServiceDisplayName);
+            record.ServiceName = ownStrings->intern(record.ServiceName);
+            for (auto& procedure : record.Procedures)
+            {
+                procedure = ownStrings->intern(procedure);
+            }
+        }
+        newTable->strings = std::move(ownStrings);
+    }
+    newTable->records = std::move(records);
+    newTable->index.reserve(newTable->records.size());
+    for (size_t i = 0; i < newTable->records.size(); i++)
+    {
+        newTable->index[newTable->records[i].InterfaceUuid] = i;
+    }
+    table = std::move(newTable);
+}
+
+std::map<std::string, std::string> RpcServersConfig::getRpcInfo(const std::string& interfaceUuid, int funcOpnum) const
+{
+    RpcUuid uuid;
+    if (!RpcUuid::parse(interfaceUuid, uuid))
+    {
+        return {};
+    }
+
+    RpcResolution resolution = resolve(uuid, funcOpnum);
+    if (!resolution.Server)
     {
         return {};
     }
 
-    auto rpcServer = it->second;
+    const RpcServerRecord& rpcServer = *resolution.Server;
     std::map<std::string, std::string> rpcInfo;
-    rpcInfo["FileName"] = rpcServer["FileName"];
+    rpcInfo["FileName"] = rpcServer.FileName;
 
-    if (!rpcServer["ServiceDisplayName"].empty())
+    if (!rpcServer.ServiceDisplayName.empty())
     {
-        rpcInfo["ServiceDisplayName"] = rpcServer["ServiceDisplayName"];
+        rpcInfo["ServiceDisplayName"] = rpcServer.ServiceDisplayName;
     }
 
-    if (!rpcServer["ServiceName"].empty())
+    if (!rpcServer.ServiceName.empty())
     {
-        rpcInfo["ServiceName"] = rpcServer["ServiceName"];
+        rpcInfo["ServiceName"] = rpcServer.ServiceName;
     }
 
-    if (funcOpnum >= 0 && funcOpnum < std::stoi(rpcServer["ProcedureCount"]))
+    if (resolution.ProcedureName)
     {
-        rpcInfo["ProcedureName"] = rpcServer["Procedures"][funcOpnum]["Name"];
+        rpcInfo["ProcedureName"] = *resolution.ProcedureName;
     }
 
     return rpcInfo;
 }
 
-RpcServersConfig RpcServersConfig::load(const std::string& filePath)
+RpcResolution RpcServersConfig::resolve(const RpcUuid& interfaceUuid, int funcOpnum) const
 {
-    std::ifstream rpcServersFile(filePath);
-    if (!rpcServersFile.is_open())
+    RpcResolution resolution;
+    auto it = table->index.find(interfaceUuid);
+    if (it == table->index.end())
     {
-        throw std::runtime_error("Could not open file: " + filePath);
+        return resolution;
     }
 
-    json root;
-    rpcServersFile >> root;
+    resolution.Server = &table->records[it->second];
+    if (funcOpnum >= 0 && static_cast<size_t>(funcOpnum) < resolution.Server->Procedures.size())
+    {
+        resolution.ProcedureName = &resolution.Server->Procedures[funcOpnum];
+    }
 
-    std::map<std::string, std::map<std::string, std::string>> rpcServersMap;
+    return resolution;
+}
 
-    for (const auto& rpcServer : root)
+uint64_t RpcServersConfig::generation() const
+{
+    return tableGeneration;
+}
+
+size_t RpcServersConfig::size() const
+{
+    return table->records.size();
+}
+
+const RpcStringPool& RpcServersConfig::strings() const
+{
+    return *table->strings;
+}
+
+RpcServersConfig RpcServersConfig::load(const std::string& filePath)
+{
+    return loadMany({ filePath });
+}
+
+RpcServersConfig RpcServersConfig::loadMany(const std::vector<std::string>& filePaths, std::vector<RpcMergeConflict>* conflicts,
+    std::vector<RpcSourceFailure>* failures)
+{
+    auto strings = std::make_shared<RpcStringPool>();
+    std::vector<RpcServerRecord> records;
+    std::vector<size_t> recordSources;
+    std::unordered_map<RpcUuid, size_t, RpcUuidHash> index;
+    size_t failedSources = 0;
+    std::string firstError;
+
+    // parse one batch of files in parallel, then merge it in file order so precedence stays deterministic
+    const size_t batchSize = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t first = 0; first < filePaths.size(); first += batchSize)
+    {
+        const size_t last = std::min(filePaths.size(), first + batchSize);
+        std::vector<std::future<std::vector<ParsedRpcServer>>> batch;
+        for (size_t i = first; i < last; i++)
+        {
+            batch.push_back(std::async(std::launch::async, parseRpcServersFile, std::cref(filePaths[i])));
+        }
+
+        for (size_t i = first; i < last; i++)
+        {
+            const std::string& sourceFile = filePaths[i];
+            std::vector<ParsedRpcServer> servers;
+            try
+            {
+                servers = batch[i - first].get();
+            }
+            catch (const std::exception& e)
+            {
+                // one unreadable source, like a crawled file of another format, must not discard the others
+                std::cerr << "Skipping RPC servers file " << sourceFile << ": " << e.what() << std::endl;
+                if (failures)
+                {
+                    failures->push_back({ sourceFile, e.what() });
+                }
+                if (failedSources++ == 0)
+                {
+                    firstError = e.what();
+                }
+                continue;
+            }
+
+            for (const auto& server : servers)
+            {
+                auto it = index.find(server.InterfaceUuid);
+                if (it == index.end())
+                {
+                    RpcServerRecord record;
+                    record.InterfaceUuid = server.InterfaceUuid;
+                    record.FileName = strings->intern(server.FileName);
+                    record.ServiceDisplayName = strings->intern(server.ServiceDisplayName);
+                    record.ServiceName = strings->intern(server.ServiceName);
+                    record.Procedures.reserve(server.Procedures.size());
+                    for (const auto& procedure : server.Procedures)
+                    {
+                        record.Procedures.push_back(strings->intern(procedure));
+                    }
+
+                    index[server.InterfaceUuid] = records.size();
+                    records.push_back(std::move(record));
+                    recordSources.push_back(i);
+                    continue;
+                }
+
+                RpcServerRecord& record = records[it->second];
+                const std::string& existingSourceFile = filePaths[recordSources[it->second]];
+                if (record.FileName != server.FileName)
+                {
+                    recordConflict(conflicts, sourceFile, existingSourceFile, server.InterfaceUuid, "FileName", record.FileName, server.FileName);
+                }
+                if (record.ServiceDisplayName != server.ServiceDisplayName)
+                {
+                    recordConflict(conflicts, sourceFile, existingSourceFile, server.InterfaceUuid, "ServiceDisplayName", record.ServiceDisplayName, server.ServiceDisplayName);
+                }
+                if (record.ServiceName != server.ServiceName)
+                {
+                    recordConflict(conflicts, sourceFile, existingSourceFile, server.InterfaceUuid, "ServiceName", record.ServiceName, server.ServiceName);
+                }
+
+                const size_t common = std::min(record.Procedures.size(), server.Procedures.size());
+                for (size_t opnum = 0; opnum < common; opnum++)
+                {
+                    if (record.Procedures[opnum] != server.Procedures[opnum])
+                    {
+                        recordConflict(conflicts, sourceFile, existingSourceFile, server.InterfaceUuid,
+                            "Procedures[" + std::to_string(opnum) + "]", record.Procedures[opnum], server.Procedures[opnum]);
+                    }
+                }
+
+                if (record.Procedures.size() != server.Procedures.size())
+                {
+                    recordConflict(conflicts, sourceFile, existingSourceFile, server.InterfaceUuid, "ProcedureCount",
+                        std::to_string(record.Procedures.size()), std::to_string(server.Procedures.size()));
+                    for (size_t opnum = common; opnum < server.Procedures.size(); opnum++)
+                    {
+                        record.Procedures.push_back(strings->intern(server.Procedures[opnum]));
+                    }
+                }
+            }
+        }
+    }
+
+    if (!filePaths.empty() && failedSources == filePaths.size())
     {
-        std::string uuidKey = "{" + rpcServer["InterfaceUuid"].get<std::string>() + "}";
-        rpcServersMap[uuidKey] = {
-            {"FileName", rpcServer["FileName"].get<std::string>()},
-            {"ServiceDisplayName", rpcServer["ServiceDisplayName"].get<std::string>()},
-            {"ServiceName", rpcServer["ServiceName"].get<std::string>()},
-            {"ProcedureCount", std::to_string(rpcServer["Procedures"].size())}
-        };
+        throw std::runtime_error(failedSources == 1 ? firstError
+            : "None of the " + std::to_string(failedSources) + " RPC servers files could be loaded, the first error was: " + firstError);
     }
 
-    return RpcServersConfig(rpcServersMap);
+    return RpcServersConfig(std::move(records), std::move(strings));
 }
@@ -0,0 +1,110 @@
+#include "../include/RpcServersDatabase.h"
+#include <iostream>
+
+RpcServersDatabase::Reader::Reader(const RpcServersDatabase& database)
+    : database(database), version(database.version())
+{
+    // read the version first so a concurrent publish at worst causes one extra refresh
+    config = database.snapshot();
+}
+
+const RpcServersConfig& RpcServersDatabase::Reader::current()
+{
+    const uint64_t latest = database.currentVersion.load(std::memory_order_acquire);
+    if (latest != version)
+    {
+        config = database.snapshot();
+        version = latest;
+    }
+    return *config;
+}
+
+RpcServersDatabase::RpcServersDatabase(const RpcServersConfig& config)
+    : currentConfig(std::make_shared<const RpcServersConfig>(config)), currentVersion(1), reloading(false) {}
+
+RpcServersDatabase::~RpcServersDatabase()
+{
+    std::lock_guard<std::mutex> guard(reloadMutex);
+    if (reloadThread.joinable())
+    {
+        reloadThread.join();
+    }
+}
+
+std::shared_ptr<const RpcServersConfig> RpcServersDatabase::snapshot() const
+{
+    return std::atomic_load_explicit(&currentConfig, std::memory_order_acquire);
+}
+
+void RpcServersDatabase::publish(const RpcServersConfig& config)
+{
+    std::atomic_store_explicit(&currentConfig, std::make_shared<const RpcServersConfig>(config), std::memory_order_release);
+    currentVersion.fetch_add(1, std::memory_order_release);
+}
+
+bool RpcServersDatabase::reloadAsync(const std::string& filePath)
+{
+    return reloadAsync(std::vector<std::string>{ filePath });
+}
+
+bool RpcServersDatabase::reloadAsync(const std::vector<std::string>& filePaths)
+{
+    std::lock_guard<std::mutex> guard(reloadMutex);
+    if (reloading)
+    {
+        return false;
+    }
+
+    if (reloadThread.joinable())
+    {
+        reloadThread.join();
+    }
+
+    reloading = true;
+    reloadThread = std::thread([this, filePaths]() {
+        std::string error;
+        std::vector<RpcSourceFailure> failures;
+        try
+        {
+            std::vector<RpcMergeConflict> conflicts;
+            publish(RpcServersConfig::loadMany(filePaths, &conflicts, &failures));
+            std::cout << "Reloaded RPC server configurations from " << filePaths.size() - failures.size() << " of "
+                << filePaths.size() << " file(s), " << conflicts.size() << " conflict(s)" << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "An error occurred while reloading RPC servers: " << e.what() << std::endl;
+            error = e.what();
+        }
+        {
+            std::lock_guard<std::mutex> errorGuard(reloadErrorMutex);
+            reloadError = std::move(error);
+            reloadFailures = std::move(failures);
+        }
+        reloading = false;
+    });
+
+    return true;
+}
+
+bool RpcServersDatabase::isReloading() const
+{
+    return reloading;
+}
+
+std::string RpcServersDatabase::lastReloadError() const
+{
+    std::lock_guard<std::mutex> guard(reloadErrorMutex);
+    return reloadError;
+}
+
+std::vector<RpcSourceFailure> RpcServersDatabase::lastReloadFailures() const
+{
+    std::lock_guard<std::mutex> guard(reloadErrorMutex);
+    return reloadFailures;
+}
+
+uint64_t RpcServersDatabase::version() const
+{
+    return currentVersion.load(std::memory_order_acquire);
+}
@@ -0,0 +1,26 @@
+#include "../include/RpcStringPool.h"
+
+std::string_view RpcStringPool::intern(std::string_view value)
+{
+    auto it = lookup.find(value);
+    if (it != lookup.end())
+    {
+        return *it;
+    }
+
+    storage.emplace_back(value);
+    storedBytes += value.size();
+    std::string_view pooled = storage.back();
+    lookup.insert(pooled);
+    return pooled;
+}
+
+size_t RpcStringPool::size() const
+{
+    return storage.size();
+}
+
+size_t RpcStringPool::bytes() const
+{
+    return storedBytes;
+}
@@ -0,0 +1,54 @@
+#include "../include/RpcTrafficSketch.h"
+
+RpcTrafficSketch::RpcTrafficSketch(size_t heavyHitterCapacity, int cardinalityPrecision)
+    : m_cardinalityPrecision(cardinalityPrecision), heavyHitters(heavyHitterCapacity) {}
+
+void RpcTrafficSketch::add(const RpcCallKey& key, double weight)
+{
+    heavyHitters.add(key, weight);
+
+    auto it = endpointsPerInterface.find(key.InterfaceUuid);
+    if (it == endpointsPerInterface.end())
+    {
+        it = endpointsPerInterface.emplace(key.InterfaceUuid, HyperLogLog(m_cardinalityPrecision)).first;
+    }
+    it->second.add(HyperLogLog::mix(rpcEndpointHash(key.Endpoint)));
+}
+
+void RpcTrafficSketch::merge(const RpcTrafficSketch& other)
+{
+    heavyHitters.merge(other.heavyHitters);
+    for (const auto& entry : other.endpointsPerInterface)
+    {
+        auto it = endpointsPerInterface.find(entry.first);
+        if (it == endpointsPerInterface.end())
+        {
+            endpointsPerInterface.emplace(entry.first, entry.second);
+        }
+        else
+        {
+            it->second.merge(entry.second);
+        }
+    }
+}
+
+std::vector<SpaceSaving<RpcCallKey, RpcCallKeyHash>::Counter> RpcTrafficSketch::topCalls(size_t count) const
+{
+    return heavyHitters.top(count);
+}
+
+double RpcTrafficSketch::distinctEndpoints(const RpcUuid& interfaceUuid) const
+{
+    auto it = endpointsPerInterface.find(interfaceUuid);
+    return it != endpointsPerInterface.end() ? it->second.estimate() : 0.0;
+}
+
+double RpcTrafficSketch::totalCalls() const
+{
+    return heavyHitters.total();
+}
+
+double RpcTrafficSketch::errorBound() const
+{
+    return heavyHitters.errorBound();
+}
@@ -0,0 +1,76 @@
+#include "../include/RpcUuid.h"
+#include <cstdio>
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool RpcUuid::parse(const std::string& text, RpcUuid& uuid)
+{
+    size_t begin = 0;
+    size_t end = text.size();
+    if (end == 38 && text[0] == '{' && text[37] == '}')
+    {
+        begin = 1;
+        end = 37;
+    }
+
+    if (end - begin != 36)
+    {
+        return false;
+    }
+
+    uint64_t parts[2] = { 0, 0 };
+    int digits = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        const size_t pos = i - begin;
+        if (pos == 8 || pos == 13 || pos == 18 || pos == 23)
+        {
+            if (text[i] != '-')
+            {
+                return false;
+            }
+            continue;
+        }
+
+        const int value = hexValue(text[i]);
+        if (value < 0)
+        {
+            return false;
+        }
+        parts[digits / 16] = (parts[digits / 16] << 4) | static_cast<uint64_t>(value);
+        digits++;
+    }
+
+    uuid.High = parts[0];
+    uuid.Low = parts[1];
+    return true;
+}
+
+std::string RpcUuid::toString() const
+{
+    char buffer[40] = { 0 };
+    snprintf(buffer, sizeof(buffer),
+        "{%08x-%04x-%04x-%04x-%012llx}",
+        static_cast<unsigned int>(High >> 32),
+        static_cast<unsigned int>((High >> 16) & 0xffff),
+        static_cast<unsigned int>(High & 0xffff),
+        static_cast<unsigned int>(Low >> 48),
+        static_cast<unsigned long long>(Low & 0xffffffffffffULL));
+
+    return std::string(buffer);
+}
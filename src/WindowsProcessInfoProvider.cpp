@@ -0,0 +1,107 @@
+#include "../include/WindowsProcessInfoProvider.h"
+#include <windows.h>
+#include <winsvc.h>
+#include <iostream>
+
+static uint64_t fileTimeToUInt64(const FILETIME& fileTime)
+{
+    return (static_cast<uint64_t>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime;
+}
+
+WindowsProcessInfoProvider::WindowsProcessInfoProvider(std::chrono::steady_clock::duration refreshInterval)
+    : m_refreshInterval(refreshInterval) {}
+
+bool WindowsProcessInfoProvider::query(uint32_t processId, ProcessAttribution& attribution)
+{
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (!process)
+    {
+        return false;
+    }
+
+    char imagePath[MAX_PATH] = { 0 };
+    DWORD imagePathLength = MAX_PATH;
+    if (QueryFullProcessImageNameA(process, 0, imagePath, &imagePathLength))
+    {
+        attribution.ImagePath.assign(imagePath, imagePathLength);
+    }
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(process, &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        attribution.StartTime = fileTimeToUInt64(creationTime);
+    }
+    CloseHandle(process);
+
+    // only a process started after the last enumeration can host services we have not seen yet, and a burst of new
+    // clients must not enumerate the services once per process
+    if (servicesSnapshotTime == 0 || attribution.StartTime > servicesSnapshotTime)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastRefresh >= m_refreshInterval)
+        {
+            lastRefresh = now;
+            refreshServices();
+        }
+        attribution.Provisional = attribution.StartTime > servicesSnapshotTime;
+    }
+
+    auto it = servicesByProcess.find(processId);
+    if (it != servicesByProcess.end())
+    {
+        for (const auto& service : it->second)
+        {
+            if (!attribution.ServiceName.empty())
+            {
+                attribution.ServiceName += ", ";
+                attribution.ServiceDisplayName += ", ";
+            }
+            attribution.ServiceName += service.first;
+            attribution.ServiceDisplayName += service.second;
+        }
+    }
+
+    attribution.ProcessId = processId;
+    return true;
+}
+
+void WindowsProcessInfoProvider::refreshServices()
+{
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+
+    SC_HANDLE scManager = OpenSCManagerA(NULL, NULL, SC_MANAGER_ENUMERATE_SERVICE);
+    if (!scManager)
+    {
+        std::cerr << "Failed to open service manager. Error: " << GetLastError() << std::endl;
+        return;
+    }
+
+    DWORD bytesNeeded = 0;
+    DWORD serviceCount = 0;
+    EnumServicesStatusExA(scManager, SC_ENUM_PROCESS_INFO, SERVICE_WIN32, SERVICE_ACTIVE, NULL, 0, &bytesNeeded, &serviceCount, NULL, NULL);
+
+    std::vector<BYTE> buffer(bytesNeeded);
+    ENUM_SERVICE_STATUS_PROCESSA* services = reinterpret_cast<ENUM_SERVICE_STATUS_PROCESSA*>(buffer.data());
+
+    if (EnumServicesStatusExA(scManager, SC_ENUM_PROCESS_INFO, SERVICE_WIN32, SERVICE_ACTIVE,
+        buffer.data(), bytesNeeded, &bytesNeeded, &serviceCount, NULL, NULL))
+    {
+        servicesByProcess.clear();
+        for (DWORD i = 0; i < serviceCount; ++i)
+        {
+            const DWORD hostProcessId = services[i].ServiceStatusProcess.dwProcessId;
+            if (hostProcessId != 0)
+            {
+                servicesByProcess[hostProcessId].emplace_back(services[i].lpServiceName, services[i].lpDisplayName);
+            }
+        }
+        servicesSnapshotTime = fileTimeToUInt64(now);
+    }
+    else
+    {
+        std::cerr << "Failed to enumerate services. Error: " << GetLastError() << std::endl;
+    }
+
+    CloseServiceHandle(scManager);
+}
@@ -1,6 +1,8 @@
 #include "../include/RpcMonitor.h"
 #include "../include/RpcServersConfig.h"
 #include "../include/FileCrawler.h"
+#include "../include/ListViewModel.h"
+#include "../include/SnapshotBuffer.h"
 #include "../externals/json/single_include/nlohmann/json.hpp"
 
 #include "imgui.h"
@@ -24,6 +26,9 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <algorithm>
+#include <chrono>
 
 
 static ID3D11Device* g_pd3dDevice = NULL;
@@ -39,7 +44,7 @@ LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 using json = nlohmann::json;
 
-RpcMonitor* monitor;
+std::unique_ptr<RpcMonitor> monitor;
 
 std::string SelectDirectory(HWND owner)
 {
@@ -57,16 +62,53 @@ std::string SelectDirectory(HWND owner)
     return "";
 }
 
+ListViewModel<RpcEvent>::Compare MakeEventCompare(int column, bool ascending)
+{
+    ListViewModel<RpcEvent>::Compare compare;
+    switch (column)
+    {
+    case 0:
+        compare = [](const RpcEvent& a, const RpcEvent& b) { return a.Timestamp < b.Timestamp; };
+        break;
+    case 1:
+        compare = [](const RpcEvent& a, const RpcEvent& b) { return a.ProcessId < b.ProcessId; };
+        break;
+    case 2:
+        compare = [](const RpcEvent& a, const RpcEvent& b) { return a.InterfaceUuid < b.InterfaceUuid; };
+        break;
+    case 3:
+        compare = [](const RpcEvent& a, const RpcEvent& b) { return a.procedureName() < b.procedureName(); };
+        break;
+    default:
+        compare = [](const RpcEvent& a, const RpcEvent& b) { return a.fileName() < b.fileName(); };
+        break;
+    }
+
+    if (ascending)
+    {
+        return compare;
+    }
+    return [compare](const RpcEvent& a, const RpcEvent& b) { return compare(b, a); };
+}
+
 void RunGuiAndMonitor(HWND hwnd)
 {
     std::string rpcServersFile;
     std::string outputFilename;
     std::string startDir;
-    static int selectedFileIndex = -1;
+    static bool mergeAllFiles = false;
 
-    std::vector<std::string> foundFiles;
+    // the crawler thread publishes its results, the render thread only ever reads the front snapshot
+    RowSnapshotBuilder<std::string> crawledFiles;
+    SnapshotBuffer<RowSnapshot<std::string>> foundFiles;
     std::atomic<bool> isCrawling(false);
-    std::mutex foundFilesMutex;
+
+    ListViewModel<std::string> fileView;
+    ListViewModel<RpcEvent> eventView;
+    char fileFilter[256] = "";
+    char eventFilter[256] = "";
+    int framesToRender = 3;
+    bool wasReloading = false;
 
     // ImGui Setup
     IMGUI_CHECKVERSION();
@@ -86,8 +128,31 @@ void RunGuiAndMonitor(HWND hwnd)
         {
             TranslateMessage(&msg);
             DispatchMessage(&msg);
+            // keep a few frames after input so hover and focus states settle
+            framesToRender = 3;
+            continue;
+        }
+
+        bool snapshotsChanged = foundFiles.update();
+        if (monitor && monitor->getEventSnapshots().update())
+        {
+            snapshotsChanged = true;
+        }
+
+        // one more frame after a reload finishes replaces the progress text with the outcome
+        const bool reloading = monitor && monitor->getDatabase().isReloading();
+        if (snapshotsChanged || reloading || reloading != wasReloading)
+        {
+            framesToRender = (std::max)(framesToRender, 1);
+        }
+        wasReloading = reloading;
+
+        if (framesToRender == 0)
+        {
+            MsgWaitForMultipleObjects(0, NULL, FALSE, 50, QS_ALLINPUT);
             continue;
         }
+        framesToRender--;
 
         ImGui_ImplDX11_NewFrame();
         ImGui_ImplWin32_NewFrame();
@@ -115,49 +180,72 @@ void RunGuiAndMonitor(HWND hwnd)
                     std::thread([&, startDir]() {
                         FileCrawler crawler(startDir);
                         std::vector<std::string> extensions = { ".json", ".xml" };
-                        std::vector<std::string> tempFiles = crawler.findFiles(extensions);
-                        {
-                            std::lock_guard<std::mutex> lock(foundFilesMutex);
-                            foundFiles = std::move(tempFiles);
-                        }
+                        crawledFiles.reset();
+                        crawledFiles.snapshot(foundFiles.back());
+                        foundFiles.publish();
+
+                        // files show up while the crawl runs, batched so a large tree does not publish once per file
+                        auto lastPublish = std::chrono::steady_clock::now();
+                        size_t unpublished = 0;
+                        crawler.findFiles(extensions, [&](const std::string& file) {
+                            crawledFiles.append(file);
+                            unpublished++;
+                            const auto now = std::chrono::steady_clock::now();
+                            if (unpublished >= 256 || now - lastPublish >= std::chrono::milliseconds(100))
+                            {
+                                crawledFiles.snapshot(foundFiles.back());
+                                foundFiles.publish();
+                                lastPublish = now;
+                                unpublished = 0;
+                            }
+                        });
+
+                        // the flag is cleared first, the render loop wakes up on the publish and must see the crawl as done
                         isCrawling = false;
+                        crawledFiles.snapshot(foundFiles.back());
+                        foundFiles.publish();
                         }).detach();
                 }
             }
 
+            const RowSnapshot<std::string>& files = foundFiles.front();
             if (isCrawling)
             {
-                ImGui::Text("Crawling for RPC files...");
+                ImGui::Text("Crawling for RPC files... %zu found so far", files.size());
             }
-            else
+            if (files.size() > 0)
             {
-                if (!foundFiles.empty())
+                ImGui::Checkbox("Merge all found files", &mergeAllFiles);
+                if (ImGui::InputText("File Filter", fileFilter, sizeof(fileFilter)))
                 {
-                    ImGui::Text("Select RPC Server File:");
-                    if (ImGui::BeginCombo("Files", selectedFileIndex == -1 ? "Select a file" : foundFiles[selectedFileIndex].c_str()))
+                    std::string needle = fileFilter;
+                    fileView.setFilter(needle.empty() ? nullptr : ListViewModel<std::string>::Predicate([needle](const std::string& path) {
+                        return path.find(needle) != std::string::npos;
+                    }));
+                }
+                fileView.update(files);
+
+                ImGui::Text("Select RPC Server File (%zu of %zu):", fileView.size(), files.size());
+                ImGui::BeginChild("Files", ImVec2(0, 120), true);
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(fileView.size()));
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
                     {
-                        std::lock_guard<std::mutex> lock(foundFilesMutex);
-                        for (int i = 0; i < foundFiles.size(); i++)
+                        const std::string& file = files[fileView[i]];
+                        if (ImGui::Selectable(file.c_str(), file == rpcServersFile))
                         {
-                            bool isSelected = (selectedFileIndex == i);
-                            if (ImGui::Selectable(foundFiles[i].c_str(), isSelected))
-                            {
-                                selectedFileIndex = i;
-                                rpcServersFile = foundFiles[selectedFileIndex];
-                                std::cout << "Selected RPC Server File: " << rpcServersFile << std::endl;
-                            }
-                            if (isSelected)
-                            {
-                                ImGui::SetItemDefaultFocus();
-                            }
+                            rpcServersFile = file;
+                            std::cout << "Selected RPC Server File: " << rpcServersFile << std::endl;
                         }
-                        ImGui::EndCombo();
                     }
                 }
-                else
-                {
-                    ImGui::Text("No RPC files found.");
-                }
+                ImGui::EndChild();
+            }
+            else if (!isCrawling)
+            {
+                ImGui::Text("No RPC files found.");
             }
         }
         else 
@@ -187,16 +275,78 @@ void RunGuiAndMonitor(HWND hwnd)
             }
         }
 
-        if (ImGui::Button("Start Monitor") && selectedFileIndex != -1 && !outputFilename.empty())
+        if (monitor)
+        {
+            if (ImGui::Button("Reload RPC Servers") && (!rpcServersFile.empty() || mergeAllFiles))
+            {
+                std::vector<std::string> sourceFiles;
+                if (mergeAllFiles)
+                {
+                    const RowSnapshot<std::string>& files = foundFiles.front();
+                    for (size_t i = 0; i < files.size(); i++)
+                    {
+                        sourceFiles.push_back(files[i]);
+                    }
+                }
+                else
+                {
+                    sourceFiles.push_back(rpcServersFile);
+                }
+
+                // the running session keeps capturing while the new database loads in the background
+                if (!monitor->getDatabase().reloadAsync(sourceFiles))
+                {
+                    std::cerr << "A reload of the RPC servers is already running." << std::endl;
+                }
+            }
+
+            if (monitor->getDatabase().isReloading())
+            {
+                ImGui::Text("Reloading RPC servers...");
+            }
+            else
+            {
+                const std::string reloadError = monitor->getDatabase().lastReloadError();
+                const std::vector<RpcSourceFailure> reloadFailures = monitor->getDatabase().lastReloadFailures();
+                if (!reloadError.empty())
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Reload failed: %s", reloadError.c_str());
+                }
+                else if (!reloadFailures.empty())
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "Reload skipped %zu file(s), first: %s: %s", reloadFailures.size(),
+                        reloadFailures.front().SourceFile.c_str(), reloadFailures.front().Error.c_str());
+                }
+            }
+        }
+        else if (ImGui::Button("Start Monitor") && (!rpcServersFile.empty() || mergeAllFiles) && !outputFilename.empty())
         {
             try
             {
-                RpcServersConfig rpcConfig = RpcServersConfig::load(rpcServersFile);
-                std::cout << "Loaded RPC server configurations from " << rpcServersFile << std::endl;
+                std::vector<std::string> sourceFiles;
+                if (mergeAllFiles)
+                {
+                    const RowSnapshot<std::string>& files = foundFiles.front();
+                    for (size_t i = 0; i < files.size(); i++)
+                    {
+                        sourceFiles.push_back(files[i]);
+                    }
+                }
+                else
+                {
+                    sourceFiles.push_back(rpcServersFile);
+                }
 
-                monitor = new RpcMonitor(rpcConfig);
+                std::vector<RpcMergeConflict> conflicts;
+                std::vector<RpcSourceFailure> failures;
+                RpcServersConfig rpcConfig = RpcServersConfig::loadMany(sourceFiles, &conflicts, &failures);
+                std::cout << "Loaded " << rpcConfig.size() << " RPC server interfaces from " << sourceFiles.size() - failures.size()
+                    << " of " << sourceFiles.size() << " file(s), " << conflicts.size() << " conflict(s)" << std::endl;
+
+                auto newMonitor = std::make_unique<RpcMonitor>(rpcConfig);
                 std::cout << "Starting RPC session..." << std::endl;
-                monitor->start();
+                newMonitor->start();
+                monitor = std::move(newMonitor);
             }
             catch (const std::exception& e)
             {
@@ -204,6 +354,85 @@ void RunGuiAndMonitor(HWND hwnd)
             }
         }
 
+        if (monitor)
+        {
+            const RowSnapshot<RpcEvent>& events = monitor->getEventSnapshots().front().rows();
+            if (ImGui::InputText("Event Filter", eventFilter, sizeof(eventFilter)))
+            {
+                std::string needle = eventFilter;
+                // rows only hold handles, the names are looked up in the snapshot the rows are filtered from
+                eventView.setFilter(needle.empty() ? nullptr : ListViewModel<RpcEvent>::Predicate([needle, &monitor](const RpcEvent& event) {
+                    const ProcessAttribution* process = monitor->getEventSnapshots().front().process(event);
+                    return event.InterfaceUuid.toString().find(needle) != std::string::npos
+                        || event.procedureName().find(needle) != std::string_view::npos
+                        || event.fileName().find(needle) != std::string_view::npos
+                        || (process && process->ImagePath.find(needle) != std::string::npos);
+                }));
+            }
+
+            const ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders
+                | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable;
+            if (ImGui::BeginTable("Events", 5, tableFlags, ImVec2(0, 220)))
+            {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Timestamp", ImGuiTableColumnFlags_DefaultSort);
+                ImGui::TableSetupColumn("PID");
+                ImGui::TableSetupColumn("Interface");
+                ImGui::TableSetupColumn("Procedure");
+                ImGui::TableSetupColumn("Server");
+                ImGui::TableHeadersRow();
+
+                ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+                if (sortSpecs && sortSpecs->SpecsDirty)
+                {
+                    if (sortSpecs->SpecsCount > 0)
+                    {
+                        const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+                        eventView.setSort(MakeEventCompare(spec.ColumnIndex, spec.SortDirection == ImGuiSortDirection_Ascending));
+                    }
+                    else
+                    {
+                        eventView.setSort(nullptr);
+                    }
+                    sortSpecs->SpecsDirty = false;
+                }
+                eventView.update(events);
+
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(eventView.size()));
+                while (clipper.Step())
+                {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+                    {
+                        const RpcEvent& event = events[eventView[i]];
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%llu", static_cast<unsigned long long>(event.Timestamp));
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%u", event.ProcessId);
+                        ImGui::TableNextColumn();
+                        const std::string interfaceUuid = event.InterfaceUuid.toString();
+                        ImGui::TextUnformatted(interfaceUuid.c_str());
+                        ImGui::TableNextColumn();
+                        const std::string_view procedureName = event.procedureName();
+                        ImGui::TextUnformatted(procedureName.data(), procedureName.data() + procedureName.size());
+                        ImGui::TableNextColumn();
+                        const std::string_view fileName = event.fileName();
+                        ImGui::TextUnformatted(fileName.data(), fileName.data() + fileName.size());
+                    }
+                }
+                ImGui::EndTable();
+            }
+            ImGui::Text("Showing %zu of %zu events", eventView.size(), events.size());
+
+            const RpcLoadShedder& shedder = monitor->getLoadShedder();
+            ImGui::Text("Sampling %s (rate %.3f), %llu seen, %llu sampled out, %llu shed",
+                shedder.sampling() ? "on" : "off", shedder.rate(),
+                static_cast<unsigned long long>(shedder.seenEvents()),
+                static_cast<unsigned long long>(shedder.sampledEvents()),
+                static_cast<unsigned long long>(shedder.shedEvents()));
+        }
+
         ImGui::End();
 
         // Rendering
@@ -219,7 +448,7 @@ void RunGuiAndMonitor(HWND hwnd)
     if (monitor)
     {
         monitor->stop();
-        delete monitor;
+        monitor.reset();
     }
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
@@ -0,0 +1,267 @@
+#include "Test.h"
+#include "../include/RpcServersConfig.h"
+#include "../include/RpcServersDatabase.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static const size_t InterfaceCount = 64;
+static const int ProcedureCount = 4;
+
+static RpcUuid interfaceUuid(size_t index)
+{
+    RpcUuid uuid;
+    uuid.High = 0x1000 + index;
+    uuid.Low = index * 0x9e3779b97f4a7c15ULL;
+    return uuid;
+}
+
+/*!
+ * @brief Build the config of one generation, every name carries the generation so a reader can tell them apart
+ * @param generation The generation
+ * @return RpcServersConfig The config, its strings live in its own pool
+ */
+static RpcServersConfig buildGeneration(uint64_t generation)
+{
+    const std::string tag = "gen" + std::to_string(generation);
+    std::vector<std::string> procedures;
+    for (int procedure = 0; procedure < ProcedureCount; procedure++)
+    {
+        procedures.push_back(tag + "_op" + std::to_string(procedure));
+    }
+    const std::string fileName = tag + ".dll";
+
+    std::vector<RpcServerRecord> records(InterfaceCount);
+    for (size_t i = 0; i < InterfaceCount; i++)
+    {
+        records[i].InterfaceUuid = interfaceUuid(i);
+        records[i].FileName = fileName;
+        records[i].ServiceName = "svc";
+        records[i].Procedures.assign(procedures.begin(), procedures.end());
+    }
+    // the strings above go away with this function, the config must have copied them
+    return RpcServersConfig(std::move(records));
+}
+
+/*!
+ * @brief Write the config of one generation as an rpc_servers.json file
+ * @param filePath The file path
+ * @param generation The generation, names match buildGeneration
+ */
+static void writeGenerationFile(const std::string& filePath, uint64_t generation)
+{
+    const std::string tag = "gen" + std::to_string(generation);
+    std::ofstream file(filePath, std::ios::trunc);
+    file << "[";
+    for (size_t i = 0; i < InterfaceCount; i++)
+    {
+        file << (i ? "," : "") << "{\"InterfaceUuid\":\"" << interfaceUuid(i).toString().substr(1, 36) << "\",\"FileName\":\""
+            << tag << ".dll\",\"ServiceDisplayName\":\"\",\"ServiceName\":\"svc\",\"Procedures\":[";
+        for (int procedure = 0; procedure < ProcedureCount; procedure++)
+        {
+            file << (procedure ? "," : "") << "{\"Name\":\"" << tag << "_op" << procedure << "\"}";
+        }
+        file << "]}";
+    }
+    file << "]";
+}
+
+/*!
+ * @brief Parse the generation out of a name built by buildGeneration
+ * @param name The name
+ * @param generation The generation
+ * @return bool True if the name has the expected form, false otherwise
+ */
+static bool parseGeneration(std::string_view name, uint64_t& generation)
+{
+    if (name.substr(0, 3) != "gen" || name.size() < 4)
+    {
+        return false;
+    }
+
+    generation = 0;
+    size_t i = 3;
+    for (; i < name.size() && name[i] >= '0' && name[i] <= '9'; i++)
+    {
+        generation = generation * 10 + static_cast<uint64_t>(name[i] - '0');
+    }
+    return i > 3;
+}
+
+TEST_CASE(readerPicksUpPublishedConfig)
+{
+    RpcServersDatabase database(buildGeneration(0));
+    RpcServersDatabase::Reader reader(database);
+    CHECK(reader.current().resolve(interfaceUuid(0), 0).Server->FileName == "gen0.dll");
+
+    database.publish(buildGeneration(1));
+    CHECK(database.version() == 2);
+    const RpcResolution resolution = reader.current().resolve(interfaceUuid(3), 2);
+    CHECK(resolution.Server->FileName == "gen1.dll");
+    CHECK(*resolution.ProcedureName == "gen1_op2");
+
+    // a reader created later starts at the latest config
+    RpcServersDatabase::Reader lateReader(database);
+    CHECK(lateReader.current().generation() == reader.current().generation());
+}
+
+TEST_CASE(reloadStressNeverMixesGenerations)
+{
+    const uint64_t generations = 2000;
+    const size_t readerCount = 4;
+
+    RpcServersDatabase database(buildGeneration(0));
+    std::atomic<uint64_t> startedPublishing(0);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> mixedViews(0);
+    std::atomic<uint64_t> backwardViews(0);
+    std::atomic<uint64_t> unknownNames(0);
+    std::atomic<uint64_t> views(0);
+
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < readerCount; r++)
+    {
+        readers.emplace_back([&, r]() {
+            RpcServersDatabase::Reader reader(database);
+            uint64_t lastGeneration = 0;
+            size_t next = r;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                // one current() call is one view, every lookup in it must come from the same generation
+                const RpcServersConfig& config = reader.current();
+                uint64_t viewGeneration = 0;
+                bool first = true;
+                for (size_t lookup = 0; lookup < InterfaceCount; lookup++, next++)
+                {
+                    const int procedure = static_cast<int>(next % ProcedureCount);
+                    const RpcResolution resolution = config.resolve(interfaceUuid(next % InterfaceCount), procedure);
+                    uint64_t fileGeneration = 0;
+                    uint64_t procedureGeneration = 0;
+                    if (!resolution.Server || !resolution.ProcedureName
+                        || !parseGeneration(resolution.Server->FileName, fileGeneration)
+                        || !parseGeneration(*resolution.ProcedureName, procedureGeneration)
+                        || *resolution.ProcedureName != "gen" + std::to_string(procedureGeneration) + "_op" + std::to_string(procedure)
+                        || resolution.Server->ServiceName != "svc")
+                    {
+                        unknownNames++;
+                        continue;
+                    }
+
+                    if (first)
+                    {
+                        viewGeneration = fileGeneration;
+                        first = false;
+                    }
+                    if (fileGeneration != viewGeneration || procedureGeneration != viewGeneration)
+                    {
+                        mixedViews++;
+                    }
+                }
+
+                if (viewGeneration < lastGeneration || viewGeneration > startedPublishing.load())
+                {
+                    backwardViews++;
+                }
+                lastGeneration = viewGeneration;
+                views++;
+            }
+        });
+    }
+
+    for (uint64_t generation = 1; generation <= generations; generation++)
+    {
+        RpcServersConfig config = buildGeneration(generation);
+        startedPublishing = generation;
+        database.publish(config);
+        if (generation % 100 == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    // make sure every reader got to run before stopping them
+    while (views.load() < readerCount * 4)
+    {
+        std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+
+    CHECK(mixedViews == 0);
+    CHECK(backwardViews == 0);
+    CHECK(unknownNames == 0);
+    CHECK(views > 0);
+    CHECK(database.version() == generations + 1);
+
+    RpcServersDatabase::Reader reader(database);
+    CHECK(reader.current().resolve(interfaceUuid(0), 0).Server->FileName == "gen" + std::to_string(generations) + ".dll");
+}
+
+TEST_CASE(reloadAsyncPublishesWhileReading)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rpcresolver_reload_test";
+    std::filesystem::create_directories(directory);
+    const std::string generationFile = (directory / "gen1.json").string();
+    writeGenerationFile(generationFile, 1);
+
+    RpcServersDatabase database(buildGeneration(0));
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> unknownNames(0);
+    std::atomic<uint64_t> reloadedViews(0);
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < 2; r++)
+    {
+        readers.emplace_back([&]() {
+            RpcServersDatabase::Reader reader(database);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const RpcResolution resolution = reader.current().resolve(interfaceUuid(5), 1);
+                uint64_t generation = 0;
+                if (!resolution.Server || !resolution.ProcedureName || !parseGeneration(resolution.Server->FileName, generation))
+                {
+                    unknownNames++;
+                    continue;
+                }
+                reloadedViews += generation == 1;
+            }
+        });
+    }
+
+    CHECK(database.reloadAsync(generationFile));
+    while (database.isReloading())
+    {
+        std::this_thread::yield();
+    }
+    CHECK(database.version() == 2);
+    CHECK(database.lastReloadError().empty());
+    while (reloadedViews.load() == 0)
+    {
+        std::this_thread::yield();
+    }
+
+    // a failed reload keeps the current config and reports why
+    CHECK(database.reloadAsync((directory / "missing.json").string()));
+    while (database.isReloading())
+    {
+        std::this_thread::yield();
+    }
+    CHECK(database.version() == 2);
+    CHECK(database.lastReloadError().find("missing.json") != std::string::npos);
+
+    stop = true;
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+    CHECK(unknownNames == 0);
+
+    RpcServersDatabase::Reader reader(database);
+    CHECK(*reader.current().resolve(interfaceUuid(5), 1).ProcedureName == "gen1_op1");
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,615 @@
+#include "Test.h"
+#include "../include/RpcUuid.h"
+#include "../include/RpcEventDecoder.h"
+#include "../include/RpcEventSchema.h"
+#include "../include/RpcEventStore.h"
+#include "../include/RpcEventPipeline.h"
+#include "../include/RpcServersConfig.h"
+#include "../include/RpcTrafficSketch.h"
+#include "../include/HyperLogLog.h"
+#include "../include/SpaceSaving.h"
+#include "../include/BoundedQueue.h"
+#include "../include/RpcEventIngest.h"
+#include "../include/RpcLoadShedder.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+static const char* const TestUuid = "{12345778-1234-abcd-ef00-0123456789ab}";
+
+static void appendUInt32(std::vector<uint8_t>& payload, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        payload.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static void appendUtf16(std::vector<uint8_t>& payload, const std::u16string& text)
+{
+    for (char16_t unit : text)
+    {
+        payload.push_back(static_cast<uint8_t>(unit));
+        payload.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+    payload.push_back(0);
+    payload.push_back(0);
+}
+
+static std::vector<uint8_t> encodePayload(const RpcUuid& uuid, uint32_t procNum, const std::u16string& endpoint, bool withSecurity)
+{
+    std::vector<uint8_t> payload;
+    appendUInt32(payload, static_cast<uint32_t>(uuid.High >> 32));
+    payload.push_back(static_cast<uint8_t>(uuid.High >> 16));
+    payload.push_back(static_cast<uint8_t>(uuid.High >> 24));
+    payload.push_back(static_cast<uint8_t>(uuid.High));
+    payload.push_back(static_cast<uint8_t>(uuid.High >> 8));
+    for (int i = 7; i >= 0; i--)
+    {
+        payload.push_back(static_cast<uint8_t>(uuid.Low >> (8 * i)));
+    }
+    appendUInt32(payload, procNum);
+    appendUInt32(payload, 3);
+    appendUtf16(payload, u"localhost");
+    appendUtf16(payload, endpoint);
+    if (withSecurity)
+    {
+        appendUInt32(payload, 1);
+        appendUInt32(payload, 6);
+        appendUInt32(payload, 10);
+        appendUInt32(payload, 3);
+    }
+    return payload;
+}
+
+TEST_CASE(uuidParseRoundTrip)
+{
+    RpcUuid uuid;
+    CHECK(RpcUuid::parse(TestUuid, uuid));
+    CHECK(uuid.toString() == TestUuid);
+
+    RpcUuid unbraced;
+    CHECK(RpcUuid::parse("12345778-1234-ABCD-EF00-0123456789AB", unbraced));
+    CHECK(unbraced == uuid);
+
+    RpcUuid invalid;
+    CHECK(!RpcUuid::parse("12345778-1234-abcd-ef00", invalid));
+    CHECK(!RpcUuid::parse("12345778-1234-abcd-ef00-0123456789ag", invalid));
+}
+
+TEST_CASE(decodeEachVersion)
+{
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+
+    const std::vector<uint8_t> version0 = encodePayload(uuid, 7, u"\\pipe\\lsass", false);
+    RpcCallPayload payload;
+    CHECK(decodeRpcEvent(RpcClientCallStartEventId, 0, version0.data(), version0.size(), payload));
+    CHECK(payload.InterfaceUuid == uuid);
+    CHECK(payload.ProcNum == 7);
+    CHECK(payload.Protocol == 3);
+    CHECK(payload.NetworkAddress == "localhost");
+    CHECK(payload.Endpoint == "\\pipe\\lsass");
+    CHECK(payload.AuthenticationLevel == 0);
+
+    const std::vector<uint8_t> version1 = encodePayload(uuid, 9, u"ncalrpc", true);
+    CHECK(decodeRpcEvent(RpcServerCallStartEventId, 1, version1.data(), version1.size(), payload));
+    CHECK(payload.ProcNum == 9);
+    CHECK(payload.Endpoint == "ncalrpc");
+    CHECK(payload.Options == 1);
+    CHECK(payload.AuthenticationLevel == 6);
+    CHECK(payload.AuthenticationService == 10);
+    CHECK(payload.ImpersonationLevel == 3);
+
+    // a newer version than any declared one is read with the newest layout
+    CHECK(decodeRpcEvent(RpcClientCallStartEventId, 4, version1.data(), version1.size(), payload));
+    CHECK(payload.ImpersonationLevel == 3);
+}
+
+TEST_CASE(decodeRejectsShortAndUnknownEvents)
+{
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+    const std::vector<uint8_t> payloadBytes = encodePayload(uuid, 1, u"ep", true);
+
+    RpcCallPayload payload;
+    CHECK(!decodeRpcEvent(RpcClientCallStartEventId, 1, payloadBytes.data(), 23, payload));
+    CHECK(!decodeRpcEvent(6, 0, payloadBytes.data(), payloadBytes.size(), payload));
+    CHECK(!decodeRpcEvent(1000, 0, payloadBytes.data(), payloadBytes.size(), payload));
+
+    // a version 1 payload cut after the endpoint keeps the fields it has
+    const size_t version0Length = encodePayload(uuid, 1, u"ep", false).size();
+    CHECK(decodeRpcEvent(RpcClientCallStartEventId, 1, payloadBytes.data(), version0Length, payload));
+    CHECK(payload.Endpoint == "ep");
+    CHECK(payload.AuthenticationLevel == 0);
+}
+
+TEST_CASE(ingestReadsTheInterfaceBeforeDecoding)
+{
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+    const std::vector<uint8_t> payloadBytes = encodePayload(uuid, 4, u"\\pipe\\lsass", true);
+
+    RpcUuid peeked;
+    CHECK(peekRpcInterface(RpcClientCallStartEventId, 1, payloadBytes.data(), payloadBytes.size(), peeked));
+    CHECK(peeked == uuid);
+    CHECK(!peekRpcInterface(RpcClientCallStartEventId, 1, payloadBytes.data(), 23, peeked));
+    CHECK(!peekRpcInterface(6, 0, payloadBytes.data(), payloadBytes.size(), peeked));
+
+    RpcSamplingOptions sampling;
+    sampling.Adaptive = false;
+    sampling.InterfaceRate = 0.0;
+    RpcLoadShedder shedder(sampling);
+    BoundedQueue<RpcIngestRecord> queue(1);
+    const auto now = std::chrono::steady_clock::now();
+
+    // an event without a declared layout never reaches the sampler
+    CHECK(!ingestRpcEvent(shedder, queue, RpcClientCallStartEventId, 1, payloadBytes.data(), 23, RpcCallRecord(), now));
+    CHECK(shedder.seenEvents() == 0);
+
+    RpcCallRecord record;
+    record.ProcessId = 42;
+    CHECK(ingestRpcEvent(shedder, queue, RpcClientCallStartEventId, 1, payloadBytes.data(), payloadBytes.size(), record, now));
+    CHECK(!ingestRpcEvent(shedder, queue, RpcClientCallStartEventId, 1, payloadBytes.data(), payloadBytes.size(), record, now));
+    CHECK(shedder.seenEvents() == 2);
+    CHECK(shedder.shedEvents() == 1);
+
+    std::vector<RpcIngestRecord> batch;
+    CHECK(queue.popAll(batch, std::chrono::milliseconds(0)));
+    CHECK(batch.size() == 1);
+    const RpcCallRecord* queued = batch.empty() ? nullptr : std::get_if<RpcCallRecord>(&batch[0]);
+    CHECK(queued && queued->ProcessId == 42 && queued->Payload.InterfaceUuid == uuid);
+    CHECK(queued && queued->Payload.ProcNum == 4 && queued->Payload.Endpoint == "\\pipe\\lsass");
+}
+
+TEST_CASE(decodeUtf16SurrogatePairs)
+{
+    const std::vector<uint8_t> text = { 0x3d, 0xd8, 0x00, 0xde, 'x', 0, 0, 0, 'y', 0 };
+    size_t bytesRead = 0;
+    CHECK(readUtf16String(text.data(), text.size(), bytesRead) == "\xf0\x9f\x98\x80x");
+    CHECK(bytesRead == 8);
+}
+
+TEST_CASE(serversConfigResolve)
+{
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+
+    RpcServerRecord record;
+    record.InterfaceUuid = uuid;
+    const std::string fileName = "lsasrv.dll";
+    const std::string procedure = "LsarOpenPolicy";
+    record.FileName = fileName;
+    record.Procedures = { procedure };
+    RpcServersConfig config({ record });
+
+    const RpcResolution resolution = config.resolve(uuid, 0);
+    CHECK(resolution.Server != nullptr);
+    CHECK(resolution.Server && resolution.Server->FileName == "lsasrv.dll");
+    CHECK(resolution.ProcedureName && *resolution.ProcedureName == "LsarOpenPolicy");
+
+    CHECK(config.resolve(uuid, 1).Server != nullptr);
+    CHECK(config.resolve(uuid, 1).ProcedureName == nullptr);
+    CHECK(config.resolve(RpcUuid(), 0).Server == nullptr);
+    CHECK(config.getRpcInfo(TestUuid, 0).size() > 0);
+}
+
+static void writeFile(const std::filesystem::path& filePath, const std::string& content)
+{
+    std::ofstream file(filePath, std::ios::trunc);
+    file << content;
+}
+
+TEST_CASE(serversConfigMergeSkipsBrokenSources)
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "rpcresolver_merge_test";
+    std::filesystem::create_directories(directory);
+    const std::string first = (directory / "first.json").string();
+    const std::string broken = (directory / "broken.xml").string();
+    const std::string second = (directory / "second.json").string();
+
+    // the second file renames the shared interface, adds a procedure to it and brings one interface of its own
+    writeFile(first, R"([{"InterfaceUuid":"12345778-1234-abcd-ef00-0123456789ab","FileName":"lsasrv.dll","ServiceDisplayName":"",)"
+        R"("ServiceName":"LSM","Procedures":[{"Name":"LsarClose"}]}])");
+    writeFile(broken, "<RpcServers><Interface/></RpcServers>");
+    writeFile(second, R"([{"InterfaceUuid":"12345778-1234-abcd-ef00-0123456789ab","FileName":"lsasrv2.dll","ServiceDisplayName":"",)"
+        R"("ServiceName":"LSM","Procedures":[{"Name":"LsarClose"},{"Name":"LsarDelete"}]},)"
+        R"({"InterfaceUuid":"00000000-0000-0000-0000-000000000001","FileName":"other.dll","ServiceDisplayName":"",)"
+        R"("ServiceName":"","Procedures":[]}])");
+
+    std::vector<RpcMergeConflict> conflicts;
+    std::vector<RpcSourceFailure> failures;
+    const RpcServersConfig config = RpcServersConfig::loadMany({ first, broken, second }, &conflicts, &failures);
+
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+    CHECK(config.size() == 2);
+    const RpcResolution resolution = config.resolve(uuid, 1);
+    CHECK(resolution.Server && resolution.Server->FileName == "lsasrv.dll");
+    CHECK(resolution.ProcedureName && *resolution.ProcedureName == "LsarDelete");
+
+    CHECK(failures.size() == 1);
+    CHECK(!failures.empty() && failures[0].SourceFile == broken && !failures[0].Error.empty());
+
+    CHECK(conflicts.size() == 2);
+    CHECK(conflicts.size() == 2 && conflicts[0].Field == "FileName" && conflicts[0].SourceFile == second
+        && conflicts[0].ExistingSourceFile == first && conflicts[0].ExistingValue == "lsasrv.dll" && conflicts[0].IncomingValue == "lsasrv2.dll");
+    CHECK(conflicts.size() == 2 && conflicts[1].Field == "ProcedureCount");
+
+    // with nothing loadable the merge fails instead of returning an empty database
+    bool threw = false;
+    try
+    {
+        RpcServersConfig::loadMany({ broken, (directory / "missing.json").string() });
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(boundedQueueRejectsWhenFull)
+{
+    BoundedQueue<int> queue(2);
+    CHECK(queue.push(1));
+    CHECK(queue.push(2));
+    CHECK(!queue.push(3));
+    CHECK(queue.size() == 2);
+
+    std::vector<int> batch;
+    CHECK(queue.popAll(batch, std::chrono::milliseconds(0)));
+    CHECK(batch == std::vector<int>({ 1, 2 }));
+
+    // closing keeps queued items available and then ends the consumer loop
+    CHECK(queue.push(4));
+    queue.close();
+    CHECK(!queue.push(5));
+    CHECK(queue.popAll(batch, std::chrono::milliseconds(0)));
+    CHECK(batch == std::vector<int>({ 4 }));
+    CHECK(!queue.popAll(batch, std::chrono::milliseconds(0)));
+}
+
+TEST_CASE(endpointHashIsFnv1a)
+{
+    // the reference values of 64 bit FNV-1a, sketches from other builds rely on them
+    CHECK(rpcEndpointHash("") == 0xcbf29ce484222325ULL);
+    CHECK(rpcEndpointHash("a") == 0xaf63dc4c8601ec8cULL);
+    CHECK(rpcEndpointHash("foobar") == 0x85944171f73967e8ULL);
+}
+
+TEST_CASE(hyperLogLogEstimate)
+{
+    HyperLogLog sketch(12);
+    HyperLogLog half(12);
+    for (uint64_t i = 0; i < 100000; i++)
+    {
+        sketch.add(HyperLogLog::mix(i));
+        if (i % 2 == 0)
+        {
+            half.add(HyperLogLog::mix(i));
+        }
+    }
+    CHECK(std::fabs(sketch.estimate() - 100000.0) / 100000.0 < 0.05);
+
+    HyperLogLog other(12);
+    for (uint64_t i = 1; i < 100000; i += 2)
+    {
+        other.add(HyperLogLog::mix(i));
+    }
+    CHECK(half.merge(other));
+    CHECK(half.estimate() == sketch.estimate());
+    CHECK(!half.merge(HyperLogLog(10)));
+}
+
+TEST_CASE(trafficSketchMergeMatchesSingleSketch)
+{
+    RpcTrafficSketch whole(64);
+    RpcTrafficSketch first(64);
+    RpcTrafficSketch second(64);
+    for (int i = 0; i < 5000; i++)
+    {
+        RpcCallKey key;
+        key.InterfaceUuid.High = static_cast<uint64_t>(i % 5);
+        key.ProcedureNum = i % 3;
+        key.ProcessId = 4;
+        key.Endpoint = "ep" + std::to_string(i % 15);
+        whole.add(key);
+        (i < 2500 ? first : second).add(key);
+    }
+    first.merge(second);
+
+    CHECK(first.totalCalls() == 5000.0);
+    RpcUuid interfaceUuid;
+    interfaceUuid.High = 2;
+    CHECK(first.distinctEndpoints(interfaceUuid) == whole.distinctEndpoints(interfaceUuid));
+    CHECK(std::fabs(whole.distinctEndpoints(interfaceUuid) - 3.0) < 0.5);
+
+    // fewer streams than counters, so every count is exact
+    const auto top = first.topCalls(20);
+    CHECK(top.size() == 15);
+    for (const auto& counter : top)
+    {
+        CHECK(std::fabs(counter.Count - 5000.0 / 15.0) <= 1.0);
+        CHECK(counter.Error == 0.0);
+    }
+}
+
+TEST_CASE(spaceSavingBoundsHoldUnderEviction)
+{
+    // 4 heavy keys among 3000 light ones with 32 counters, the light keys keep evicting each other
+    const size_t capacity = 32;
+    SpaceSaving<int> whole(capacity);
+    SpaceSaving<int> first(capacity);
+    SpaceSaving<int> second(capacity);
+    std::vector<double> exact(3004, 0.0);
+    for (int i = 0; i < 30000; i++)
+    {
+        const int key = i % 3 == 0 ? 3000 + (i / 3) % 4 : (i * 7919) % 3000;
+        exact[static_cast<size_t>(key)] += 1.0;
+        whole.add(key);
+        (i % 2 == 0 ? first : second).add(key);
+    }
+    first.merge(second);
+
+    CHECK(whole.total() == 30000.0);
+    CHECK(first.total() == 30000.0);
+    for (const SpaceSaving<int>* summary : { &whole, &first })
+    {
+        // merging adds the error bounds of both halves
+        const double bound = summary == &whole ? whole.errorBound() : 2.0 * 15000.0 / static_cast<double>(capacity);
+        const auto top = summary->top(capacity);
+        CHECK(top.size() == capacity);
+
+        size_t evictedCounters = 0;
+        for (const auto& counter : top)
+        {
+            const double trueCount = exact[static_cast<size_t>(counter.Item)];
+            CHECK(counter.Count >= trueCount);
+            CHECK(counter.Count - trueCount <= counter.Error + 1e-9);
+            CHECK(counter.Error <= bound + 1e-9);
+            evictedCounters += counter.Error > 0.0;
+        }
+        CHECK(evictedCounters > 0);
+
+        // every key heavier than the bound is reported, here the 4 heavy keys lead
+        for (int key = 3000; key < 3004; key++)
+        {
+            CHECK(exact[static_cast<size_t>(key)] > bound);
+            bool reported = false;
+            for (size_t i = 0; i < 4; i++)
+            {
+                reported = reported || top[i].Item == key;
+            }
+            CHECK(reported);
+        }
+    }
+}
+
+TEST_CASE(eventStoreQueryMatchesScan)
+{
+    RpcEventStore store;
+    std::vector<RpcUuid> interfaces(7);
+    for (size_t i = 0; i < interfaces.size(); i++)
+    {
+        interfaces[i].High = i + 1;
+    }
+
+    // spans several sealed segments and an unsealed tail
+    const size_t count = 3 * RpcEventStore::SegmentRows + 100;
+    for (size_t i = 0; i < count; i++)
+    {
+        RpcEvent event;
+        event.ProcessId = static_cast<uint32_t>(i % 11) * 4;
+        event.Timestamp = 1000 + i;
+        event.ProcedureNum = static_cast<uint16_t>(i % 13);
+        event.InterfaceUuid = interfaces[i % interfaces.size()];
+        store.append(event, "LRPC-" + std::to_string(i % 5));
+    }
+
+    RpcEventSnapshot snapshot;
+    store.snapshot(snapshot);
+    CHECK(snapshot.size() == count);
+    CHECK(snapshot.endpoint(snapshot.rows()[7]) == "LRPC-2");
+    CHECK(snapshot.rows()[7].EndpointId == snapshot.rows()[2].EndpointId);
+    CHECK(snapshot.process(snapshot.rows()[7]) == nullptr);
+
+    RpcEventQuery query;
+    query.InterfaceUuid = interfaces[3];
+    query.ProcessId = 8;
+    query.From = 5000;
+    query.To = 20000;
+    query.Predicate = [](const RpcEvent& event) { return event.ProcedureNum < 6; };
+
+    std::vector<uint64_t> expected;
+    for (size_t i = 0; i < count; i++)
+    {
+        const RpcEvent& event = store[i];
+        if (event.InterfaceUuid == interfaces[3] && event.ProcessId == 8 && event.Timestamp >= 5000
+            && event.Timestamp <= 20000 && event.ProcedureNum < 6)
+        {
+            expected.push_back(event.Timestamp);
+        }
+    }
+
+    std::vector<uint64_t> found;
+    for (const RpcEvent& event : snapshot.query(query))
+    {
+        found.push_back(event.Timestamp);
+    }
+    CHECK(!expected.empty());
+    CHECK(found == expected);
+}
+
+/// @brief FixedProcessInfoProvider class to attribute every PID to one image \class FixedProcessInfoProvider
+class FixedProcessInfoProvider : public ProcessInfoProvider
+{
+public:
+    bool query(uint32_t processId, ProcessAttribution& attribution) override
+    {
+        attribution.ImagePath = "C:\\Windows\\System32\\svchost.exe";
+        attribution.ServiceName = "svc" + std::to_string(processId);
+        attribution.StartTime = 10;
+        return true;
+    }
+};
+
+TEST_CASE(eventPipelineResolvesAttributesAndStores)
+{
+    RpcUuid uuid;
+    RpcUuid::parse(TestUuid, uuid);
+    RpcServerRecord record;
+    record.InterfaceUuid = uuid;
+    const std::string fileName = "lsasrv.dll";
+    const std::string procedure = "LsarOpenPolicy";
+    record.FileName = fileName;
+    record.Procedures = { procedure };
+
+    RpcEventPipeline pipeline(std::make_shared<RpcServersDatabase>(RpcServersConfig({ record })),
+        std::make_unique<FixedProcessInfoProvider>());
+
+    RpcCallRecord call;
+    call.ProcessId = 8;
+    call.ThreadId = 12;
+    call.Timestamp = 100;
+    call.Weight = 2.0;
+    call.Payload.InterfaceUuid = uuid;
+    call.Payload.ProcNum = 0;
+    call.Payload.Protocol = 3;
+    call.Payload.Endpoint = "lsarpc";
+    pipeline.process(call);
+
+    // an unknown interface is still stored, just without names
+    call.Payload.InterfaceUuid = RpcUuid();
+    call.Timestamp = 200;
+    pipeline.process(call);
+    CHECK(pipeline.size() == 2);
+
+    const RpcEventSnapshot events = pipeline.getEvents();
+    CHECK(events.size() == 2);
+    const RpcEvent& resolved = events.rows()[0];
+    CHECK(resolved.InterfaceUuid == uuid);
+    CHECK(resolved.fileName() == "lsasrv.dll");
+    CHECK(resolved.procedureName() == "LsarOpenPolicy");
+    CHECK(events.endpoint(resolved) == "lsarpc");
+    CHECK(events.process(resolved) && events.process(resolved)->ImagePath == "C:\\Windows\\System32\\svchost.exe");
+    CHECK(events.process(resolved) && events.process(resolved)->ServiceName == "svc8");
+    CHECK(resolved.ThreadId == 12);
+    CHECK(resolved.Protocol == 3);
+    CHECK(resolved.Weight == 2.0f);
+    CHECK(events.rows()[1].fileName().empty());
+    CHECK(events.rows()[1].procedureName().empty());
+    // rows hold handles, the endpoint and the attribution are stored once
+    CHECK(events.rows()[1].EndpointId == resolved.EndpointId);
+    CHECK(events.rows()[1].ProcessInfoId == resolved.ProcessInfoId);
+    CHECK(sizeof(RpcEvent) <= 56);
+
+    RpcEventQuery query;
+    query.InterfaceUuid = uuid;
+    size_t matches = 0;
+    for (const RpcEvent& event : events.query(query))
+    {
+        matches += event.Timestamp == 100;
+    }
+    CHECK(matches == 1);
+
+    // the range and its iterators keep a temporary snapshot alive
+    size_t temporaryMatches = 0;
+    for (const RpcEvent& event : pipeline.getEvents().query(query))
+    {
+        temporaryMatches += event.Timestamp == 100;
+    }
+    CHECK(temporaryMatches == 1);
+    const RpcEventIterator first = pipeline.getEvents().query(query).begin();
+    CHECK(first != RpcEventIterator() && first->Timestamp == 100);
+    CHECK(pipeline.getTrafficSketch().totalCalls() == 4.0);
+
+    SnapshotBuffer<RpcEventSnapshot>& snapshots = pipeline.getEventSnapshots();
+    CHECK(!snapshots.update());
+    pipeline.publishEvents(true);
+    CHECK(snapshots.update());
+    CHECK(snapshots.front().size() == 2);
+    pipeline.publishEvents(true);
+    CHECK(!snapshots.update());
+
+    // events keep the names they were resolved with after the database is reloaded
+    RpcServerRecord renamed = record;
+    const std::string renamedFile = "lsasrv2.dll";
+    renamed.FileName = renamedFile;
+    const std::weak_ptr<const RpcServersConfig> previous = pipeline.getDatabase().snapshot();
+    pipeline.getDatabase().publish(RpcServersConfig({ renamed }));
+    call.Payload.InterfaceUuid = uuid;
+    call.Timestamp = 300;
+    pipeline.process(call);
+    const RpcEventSnapshot reloaded = pipeline.getEvents();
+    CHECK(previous.expired());
+    CHECK(reloaded.rows()[0].fileName() == "lsasrv.dll");
+    CHECK(reloaded.rows()[0].procedureName() == "LsarOpenPolicy");
+    CHECK(reloaded.rows()[2].fileName() == "lsasrv2.dll");
+
+    // an unchanged record is copied once, however often the database is reloaded
+    pipeline.getDatabase().publish(RpcServersConfig({ renamed }));
+    call.Timestamp = 400;
+    pipeline.process(call);
+    const RpcEventSnapshot republished = pipeline.getEvents();
+    CHECK(republished.rows()[3].Server == republished.rows()[2].Server);
+}
+
+/// @brief ReusedProcessInfoProvider class to answer for a PID that exited and was reused by a new process \class ReusedProcessInfoProvider
+class ReusedProcessInfoProvider : public ProcessInfoProvider
+{
+public:
+    bool query(uint32_t, ProcessAttribution& attribution) override
+    {
+        // the first query finds the old process, later ones the process that reused its PID
+        attribution.ImagePath = queries == 0 ? "old.exe" : "new.exe";
+        attribution.StartTime = queries == 0 ? 100 : 200;
+        queries++;
+        return true;
+    }
+
+private:
+    int queries = 0;
+};
+
+TEST_CASE(eventPipelineAppliesProcessChangesInOrder)
+{
+    RpcEventPipeline pipeline(std::make_shared<RpcServersDatabase>(RpcServersConfig(std::vector<RpcServerRecord>())),
+        std::make_unique<ReusedProcessInfoProvider>());
+
+    RpcCallRecord call;
+    call.ProcessId = 7;
+    call.Payload.Endpoint = "ep";
+    RpcProcessChange change;
+    change.ProcessId = 7;
+
+    // one batch as the processing thread pops it, the PID exits and is reused between the two calls
+    std::vector<RpcIngestRecord> batch;
+    call.Timestamp = 150;
+    batch.push_back(call);
+    change.Timestamp = 180;
+    change.Started = false;
+    batch.push_back(change);
+    change.Timestamp = 200;
+    change.Started = true;
+    batch.push_back(change);
+    call.Timestamp = 250;
+    batch.push_back(call);
+    for (const RpcIngestRecord& record : batch)
+    {
+        pipeline.process(record);
+    }
+
+    const RpcEventSnapshot events = pipeline.getEvents();
+    CHECK(events.size() == 2);
+    const ProcessAttribution* before = events.process(events.rows()[0]);
+    const ProcessAttribution* after = events.process(events.rows()[1]);
+    CHECK(before && before->ImagePath == "old.exe");
+    CHECK(after && after->ImagePath == "new.exe");
+}
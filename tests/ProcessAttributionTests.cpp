@@ -0,0 +1,237 @@
+#include "Test.h"
+#include "../include/ProcessAttributionCache.h"
+#include "../include/ProcfsProcessInfoProvider.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static std::string imagePathOf(pid_t processId)
+{
+    char imagePath[4096];
+    const ssize_t length = readlink(("/proc/" + std::to_string(processId) + "/exe").c_str(), imagePath, sizeof(imagePath));
+    return length > 0 ? std::string(imagePath, static_cast<size_t>(length)) : std::string();
+}
+
+/*!
+ * @brief Fork a child that blocks until it is killed
+ * @return pid_t The child process ID
+ */
+static pid_t startChild()
+{
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        for (;;)
+        {
+            pause();
+        }
+    }
+    return child;
+}
+
+static void stopChild(pid_t child)
+{
+    kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+}
+
+/// @brief CountingProvider class to count the queries that reach a provider \class CountingProvider
+class CountingProvider : public ProcessInfoProvider
+{
+public:
+    explicit CountingProvider(int& queries) : queries(queries) {}
+
+    bool query(uint32_t, ProcessAttribution&) override
+    {
+        queries++;
+        return false;
+    }
+
+private:
+    int& queries;
+};
+
+/// @brief ProvisionalProvider class to answer provisionally until told the full answer is available \class ProvisionalProvider
+class ProvisionalProvider : public ProcessInfoProvider
+{
+public:
+    ProvisionalProvider(int& queries, const bool& complete) : queries(queries), complete(complete) {}
+
+    bool query(uint32_t, ProcessAttribution& attribution) override
+    {
+        queries++;
+        attribution.ImagePath = "client.exe";
+        attribution.ServiceName = complete ? "svc" : "";
+        attribution.Provisional = !complete;
+        return true;
+    }
+
+private:
+    int& queries;
+    const bool& complete;
+};
+
+TEST_CASE(procfsAttributesOwnProcess)
+{
+    ProcessAttributionCache cache(std::make_unique<ProcfsProcessInfoProvider>());
+    const uint32_t self = static_cast<uint32_t>(getpid());
+
+    const std::shared_ptr<const ProcessAttribution> attribution = cache.lookup(self);
+    CHECK(attribution != nullptr);
+    CHECK(attribution && attribution->ProcessId == self);
+    CHECK(attribution && attribution->ImagePath == imagePathOf(getpid()));
+    CHECK(attribution && attribution->StartTime > 0);
+    CHECK(cache.misses() == 1);
+
+    CHECK(cache.lookup(self) == attribution);
+    CHECK(cache.hits() == 1);
+    CHECK(cache.size() == 1);
+}
+
+TEST_CASE(procfsChildInvalidatedOnExit)
+{
+    ProcessAttributionCache cache(std::make_unique<ProcfsProcessInfoProvider>());
+    const pid_t child = startChild();
+    CHECK(child > 0);
+    if (child <= 0)
+    {
+        return;
+    }
+
+    const uint32_t childId = static_cast<uint32_t>(child);
+    const std::shared_ptr<const ProcessAttribution> attribution = cache.lookup(childId);
+    CHECK(attribution && !attribution->ImagePath.empty());
+    CHECK(attribution && attribution->StartTime >= cache.lookup(static_cast<uint32_t>(getpid()))->StartTime);
+
+    // an event from before the child started belongs to an earlier process with the same PID
+    CHECK(attribution && cache.lookup(childId, attribution->StartTime - 1) == nullptr);
+    CHECK(attribution && cache.lookup(childId, attribution->StartTime) == attribution);
+
+    // until the exit event arrives the cached entry keeps serving events still in flight
+    stopChild(child);
+    CHECK(cache.lookup(childId) == attribution);
+
+    cache.onProcessExit(childId);
+    const std::shared_ptr<const ProcessAttribution> afterExit = cache.lookup(childId);
+    CHECK(afterExit != nullptr);
+    CHECK(afterExit && afterExit->ImagePath.empty());
+    CHECK(afterExit && afterExit->StartTime == 0);
+}
+
+TEST_CASE(processStartDropsReusedProcessId)
+{
+    ProcessAttributionCache cache(std::make_unique<ProcfsProcessInfoProvider>());
+    const uint32_t self = static_cast<uint32_t>(getpid());
+    const std::shared_ptr<const ProcessAttribution> attribution = cache.lookup(self);
+    CHECK(attribution != nullptr);
+    if (!attribution)
+    {
+        return;
+    }
+
+    // a start event at or before the cached start time is the cached process itself
+    cache.onProcessStart(self, attribution->StartTime);
+    CHECK(cache.size() == 1);
+
+    cache.onProcessStart(self, attribution->StartTime + 1);
+    CHECK(cache.size() == 0);
+    CHECK(cache.lookup(self) != attribution);
+    CHECK(cache.misses() == 2);
+}
+
+TEST_CASE(unknownProcessesExpire)
+{
+    int queries = 0;
+    ProcessAttributionCache cache(std::make_unique<CountingProvider>(queries), 64, std::chrono::milliseconds(50));
+
+    CHECK(cache.lookup(12345) != nullptr);
+    CHECK(cache.lookup(12345) != nullptr);
+    CHECK(queries == 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    CHECK(cache.lookup(12345) != nullptr);
+    CHECK(queries == 2);
+    CHECK(cache.size() == 1);
+}
+
+TEST_CASE(provisionalAttributionsExpire)
+{
+    int queries = 0;
+    bool complete = false;
+    ProcessAttributionCache cache(std::make_unique<ProvisionalProvider>(queries, complete), 64, std::chrono::milliseconds(50));
+
+    // a provisional answer serves events like a full one, but only until it expires
+    const std::shared_ptr<const ProcessAttribution> provisional = cache.lookup(12345);
+    CHECK(provisional && provisional->ImagePath == "client.exe" && provisional->ServiceName.empty());
+    CHECK(cache.lookup(12345) == provisional);
+    CHECK(queries == 1);
+
+    complete = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    const std::shared_ptr<const ProcessAttribution> full = cache.lookup(12345);
+    CHECK(full && full->ServiceName == "svc");
+    CHECK(queries == 2);
+
+    // a full answer stays until the process exits
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    CHECK(cache.lookup(12345) == full);
+    CHECK(queries == 2);
+}
+
+TEST_CASE(concurrentLookupsAndExits)
+{
+    int queries = 0;
+    ProcessAttributionCache cache(std::make_unique<CountingProvider>(queries), 64, std::chrono::milliseconds(1));
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> wrongProcess(0);
+    std::atomic<uint64_t> lookups(0);
+
+    std::vector<std::thread> readers;
+    for (uint32_t r = 0; r < 4; r++)
+    {
+        readers.emplace_back([&, r]() {
+            for (uint32_t i = r; !stop.load(std::memory_order_relaxed); i++)
+            {
+                const uint32_t processId = (i % 256) * 4;
+                const std::shared_ptr<const ProcessAttribution> attribution = cache.lookup(processId);
+                if (!attribution || attribution->ProcessId != processId)
+                {
+                    wrongProcess++;
+                }
+                lookups++;
+            }
+        });
+    }
+
+    while (lookups.load() < 1000)
+    {
+        std::this_thread::yield();
+    }
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        if (i % 2 == 0)
+        {
+            cache.onProcessExit((i % 256) * 4);
+        }
+        else
+        {
+            cache.onProcessStart((i % 256) * 4, i);
+        }
+    }
+    stop = true;
+    for (auto& thread : readers)
+    {
+        thread.join();
+    }
+
+    CHECK(wrongProcess == 0);
+    CHECK(queries > 0);
+    CHECK(cache.size() <= 256);
+}
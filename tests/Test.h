@@ -0,0 +1,95 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+/// @brief TestCase struct to store one registered test \struct TestCase
+struct TestCase
+{
+    const char* Name;
+    void (*Function)();
+};
+
+/*!
+ * @brief Get the tests registered in this executable
+ * @return std::vector<TestCase>& The tests, in registration order
+ */
+inline std::vector<TestCase>& testCases()
+{
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+/*!
+ * @brief Get the number of failed checks of the running test
+ * @return int& The failure count
+ */
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+/*!
+ * @brief Report a failed check
+ * @param file The source file of the check
+ * @param line The line of the check
+ * @param expression The checked expression
+ */
+inline void testFailed(const char* file, int line, const char* expression)
+{
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+    testFailures()++;
+}
+
+/// @brief TestRegistrar struct to register a test from a static initializer \struct TestRegistrar
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*function)())
+    {
+        testCases().push_back(TestCase{ name, function });
+    }
+};
+
+/*!
+ * @brief Run the registered tests
+ * @param argc The argument count
+ * @param argv The arguments, an optional substring selects the tests to run
+ * @return int 0 if every check passed, 1 otherwise
+ */
+inline int runTests(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : "";
+    int failedTests = 0;
+    for (const TestCase& test : testCases())
+    {
+        if (!std::strstr(test.Name, filter))
+        {
+            continue;
+        }
+
+        testFailures() = 0;
+        test.Function();
+        std::cout << (testFailures() == 0 ? "[ pass ] " : "[ FAIL ] ") << test.Name << std::endl;
+        failedTests += testFailures() != 0;
+    }
+    return failedTests == 0 ? 0 : 1;
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const TestRegistrar name##Registrar(#name, &name); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            testFailed(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#endif // TEST_H
@@ -0,0 +1,6 @@
+#include "Test.h"
+
+int main(int argc, char** argv)
+{
+    return runTests(argc, argv);
+}
@@ -0,0 +1,190 @@
+#include "Test.h"
+#include "../include/SnapshotBuffer.h"
+#include "../include/ListViewModel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// @brief SequencedSnapshot struct to detect torn snapshots, every value must equal the sequence \struct SequencedSnapshot
+struct SequencedSnapshot
+{
+    uint64_t Sequence = 0;
+    std::vector<uint64_t> Values;
+};
+
+/// @brief TestRow struct to store one row of a list view test \struct TestRow
+struct TestRow
+{
+    int Key;
+    int Value;
+};
+
+/*!
+ * @brief Build the visible row indexes the slow way, to compare with the incremental view model
+ * @param rows The rows
+ * @param filter The filter, may be null
+ * @param compare The comparison, may be null
+ * @return std::vector<size_t> The visible row indexes
+ */
+static std::vector<size_t> expectedRows(const RowSnapshot<TestRow>& rows, const ListViewModel<TestRow>::Predicate& filter,
+    const ListViewModel<TestRow>::Compare& compare)
+{
+    std::vector<size_t> visible;
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        if (!filter || filter(rows[i]))
+        {
+            visible.push_back(i);
+        }
+    }
+    if (compare)
+    {
+        std::stable_sort(visible.begin(), visible.end(), [&](size_t a, size_t b) { return compare(rows[a], rows[b]); });
+    }
+    return visible;
+}
+
+static std::vector<size_t> visibleRows(const ListViewModel<TestRow>& view)
+{
+    std::vector<size_t> visible;
+    for (size_t position = 0; position < view.size(); position++)
+    {
+        visible.push_back(view[position]);
+    }
+    return visible;
+}
+
+TEST_CASE(snapshotBufferHandsOffWithoutTearing)
+{
+    SnapshotBuffer<SequencedSnapshot> buffer;
+    const uint64_t snapshots = 100000;
+    std::atomic<bool> done(false);
+
+    std::thread worker([&]() {
+        for (uint64_t sequence = 1; sequence <= snapshots; sequence++)
+        {
+            SequencedSnapshot& back = buffer.back();
+            back.Sequence = sequence;
+            back.Values.assign(64, sequence);
+            buffer.publish();
+        }
+        done = true;
+    });
+
+    uint64_t lastSequence = 0;
+    uint64_t pickedUp = 0;
+    uint64_t torn = 0;
+    uint64_t repeated = 0;
+    for (;;)
+    {
+        const bool finished = done.load();
+        while (buffer.update())
+        {
+            const SequencedSnapshot& front = buffer.front();
+            for (uint64_t value : front.Values)
+            {
+                torn += value != front.Sequence;
+            }
+            repeated += front.Sequence <= lastSequence;
+            lastSequence = front.Sequence;
+            pickedUp++;
+        }
+        if (finished)
+        {
+            break;
+        }
+    }
+    worker.join();
+
+    CHECK(torn == 0);
+    CHECK(repeated == 0);
+    CHECK(pickedUp > 0);
+    // the newest snapshot is never lost, whatever the reader skipped in between
+    CHECK(lastSequence == snapshots);
+    CHECK(!buffer.update());
+}
+
+TEST_CASE(snapshotBufferUpdateWithoutPublish)
+{
+    SnapshotBuffer<int> buffer;
+    CHECK(!buffer.update());
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK(buffer.front() == 2);
+    CHECK(!buffer.update());
+    CHECK(buffer.front() == 2);
+}
+
+TEST_CASE(listViewFiltersSortsAndMapsRows)
+{
+    RowSnapshotBuilder<TestRow> builder;
+    for (int i = 0; i < 3000; i++)
+    {
+        builder.append(TestRow{ i, (i * 7919) % 101 });
+    }
+    RowSnapshot<TestRow> rows;
+    builder.snapshot(rows);
+
+    ListViewModel<TestRow> view;
+    CHECK(view.update(rows));
+    CHECK(view.size() == rows.size());
+    CHECK(view[42] == 42);
+    CHECK(!view.update(rows));
+
+    const ListViewModel<TestRow>::Predicate filter = [](const TestRow& row) { return row.Value % 3 == 0; };
+    const ListViewModel<TestRow>::Compare compare = [](const TestRow& a, const TestRow& b) { return a.Value > b.Value; };
+    view.setFilter(filter);
+    CHECK(view.update(rows));
+    CHECK(visibleRows(view) == expectedRows(rows, filter, nullptr));
+
+    view.setSort(compare);
+    CHECK(view.update(rows));
+    CHECK(visibleRows(view) == expectedRows(rows, filter, compare));
+    for (size_t position = 0; position < view.size(); position++)
+    {
+        CHECK(filter(rows[view[position]]));
+    }
+
+    view.setFilter(nullptr);
+    view.setSort(nullptr);
+    CHECK(view.update(rows));
+    CHECK(visibleRows(view) == expectedRows(rows, nullptr, nullptr));
+}
+
+TEST_CASE(listViewMergesAppendedRows)
+{
+    const ListViewModel<TestRow>::Predicate filter = [](const TestRow& row) { return row.Value != 5; };
+    const ListViewModel<TestRow>::Compare compare = [](const TestRow& a, const TestRow& b) { return a.Value < b.Value; };
+
+    RowSnapshotBuilder<TestRow> builder;
+    ListViewModel<TestRow> view;
+    view.setFilter(filter);
+    view.setSort(compare);
+
+    // appends cross chunk boundaries, the merged result must match a full rebuild and keep equal keys in capture order
+    RowSnapshot<TestRow> rows;
+    for (int round = 0; round < 8; round++)
+    {
+        for (int i = 0; i < 700; i++)
+        {
+            const int key = round * 700 + i;
+            builder.append(TestRow{ key, (key * 31) % 17 });
+        }
+        builder.snapshot(rows);
+        CHECK(view.update(rows));
+        CHECK(visibleRows(view) == expectedRows(rows, filter, compare));
+    }
+
+    // a reset starts a new generation, rows with the old indexes must not survive
+    builder.reset();
+    builder.append(TestRow{ 0, 1 });
+    builder.snapshot(rows);
+    CHECK(view.update(rows));
+    CHECK(view.size() == 1);
+    CHECK(view[0] == 0);
+}